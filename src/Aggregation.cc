@@ -0,0 +1,57 @@
+#include "Aggregation.h"
+
+static bool NeedsEscape(char c)
+{
+    return c == AGGREGATE_DELIMITER || c == AGGREGATE_ESCAPE;
+}
+
+size_t AggregateSize(const _STD string &message)
+{
+    size_t size = message.size();
+    for (auto c : message)
+    {
+        size += NeedsEscape(c);
+    }
+
+    return size;
+}
+
+void AggregateAppend(_STD string &payload, const _STD string &message, int count)
+{
+    // the first message goes in as is, the others after a delimiter
+    if (count > 0)
+    {
+        payload += AGGREGATE_DELIMITER;
+    }
+
+    for (auto c : message)
+    {
+        if (NeedsEscape(c))
+        {
+            payload += AGGREGATE_ESCAPE;
+        }
+
+        payload += c;
+    }
+}
+
+void AggregateSplit(const char *payload, _STD vector<_STD string> &messages)
+{
+    messages.emplace_back();
+    for (auto p = payload; *p; p++)
+    {
+        if (*p == AGGREGATE_DELIMITER)
+        {
+            messages.emplace_back();
+            continue;
+        }
+
+        // a trailing escape is kept as is
+        if (*p == AGGREGATE_ESCAPE && p[1])
+        {
+            p++;
+        }
+
+        messages.back() += *p;
+    }
+}
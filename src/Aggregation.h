@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Common.h"
+
+#include <string>
+#include <vector>
+
+// several messages in one data frame, joined by a delimiter. Delimiter and escape bytes inside a
+// message are escaped, the result is a plain string payload that the framing stuffs as usual
+
+#define AGGREGATE_DELIMITER '|'
+#define AGGREGATE_ESCAPE '\\'
+
+// size of a message once escaped, without the delimiter
+size_t AggregateSize(const _STD string &message);
+
+// appends the message to an aggregated payload that already holds count messages. The count, not
+// the payload length, decides on the delimiter since a message may be empty
+void AggregateAppend(_STD string &payload, const _STD string &message, int count);
+
+// splits an aggregated payload back into its messages
+void AggregateSplit(const char *payload, _STD vector<_STD string> &messages);
@@ -0,0 +1,240 @@
+#include "ByteStuffing.h"
+
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define STUFFING_X86
+#include <immintrin.h>
+#endif
+
+static inline bool IsSpecial(char c)
+{
+    return c == STUFFING_FLAG || c == STUFFING_ESCAPE;
+}
+
+// scalar paths, also used for the tails of the vector paths
+
+static size_t EncodeScalar(const char *in, size_t len, char *out)
+{
+    size_t o = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        if (IsSpecial(in[i]))
+        {
+            out[o++] = STUFFING_ESCAPE;
+        }
+
+        out[o++] = in[i];
+    }
+
+    return o;
+}
+
+static size_t UnescapeScalar(const char *in, size_t len, char *out)
+{
+    size_t o = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        // a lone escape (not followed by a special byte) is kept as is
+        if (in[i] == STUFFING_ESCAPE && i + 1 < len && IsSpecial(in[i + 1]))
+        {
+            i++;
+        }
+
+        out[o++] = in[i];
+    }
+
+    return o;
+}
+
+#ifdef STUFFING_X86
+
+// 16 bytes at a time, a clean block is copied with a single store. On a hit the whole block is
+// stored anyway and only the clean prefix is kept, the worst case buffer sizes leave room for that
+
+static size_t EncodeSSE2(const char *in, size_t len, char *out)
+{
+    const auto flag = _mm_set1_epi8(STUFFING_FLAG);
+    const auto esc = _mm_set1_epi8(STUFFING_ESCAPE);
+
+    size_t i = 0, o = 0;
+    while (i + 16 <= len)
+    {
+        auto v = _mm_loadu_si128((const __m128i *)(in + i));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, flag), _mm_cmpeq_epi8(v, esc)));
+
+        _mm_storeu_si128((__m128i *)(out + o), v);
+        if (mask == 0)
+        {
+            i += 16;
+            o += 16;
+            continue;
+        }
+
+        int k = __builtin_ctz(mask);
+        o += k;
+        out[o++] = STUFFING_ESCAPE;
+        out[o++] = in[i + k];
+        i += k + 1;
+    }
+
+    return o + EncodeScalar(in + i, len - i, out + o);
+}
+
+static size_t UnescapeSSE2(const char *in, size_t len, char *out)
+{
+    const auto esc = _mm_set1_epi8(STUFFING_ESCAPE);
+
+    size_t i = 0, o = 0;
+    while (i + 16 <= len)
+    {
+        auto v = _mm_loadu_si128((const __m128i *)(in + i));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, esc));
+
+        _mm_storeu_si128((__m128i *)(out + o), v);
+        if (mask == 0)
+        {
+            i += 16;
+            o += 16;
+            continue;
+        }
+
+        int k = __builtin_ctz(mask);
+        o += k;
+        i += k;
+
+        if (i + 1 < len && IsSpecial(in[i + 1]))
+        {
+            i++;
+        }
+
+        out[o++] = in[i++];
+    }
+
+    return o + UnescapeScalar(in + i, len - i, out + o);
+}
+
+__attribute__((target("avx2"))) static size_t EncodeAVX2(const char *in, size_t len, char *out)
+{
+    const auto flag = _mm256_set1_epi8(STUFFING_FLAG);
+    const auto esc = _mm256_set1_epi8(STUFFING_ESCAPE);
+
+    size_t i = 0, o = 0;
+    while (i + 32 <= len)
+    {
+        auto v = _mm256_loadu_si256((const __m256i *)(in + i));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, flag), _mm256_cmpeq_epi8(v, esc)));
+
+        _mm256_storeu_si256((__m256i *)(out + o), v);
+        if (mask == 0)
+        {
+            i += 32;
+            o += 32;
+            continue;
+        }
+
+        int k = __builtin_ctz(mask);
+        o += k;
+        out[o++] = STUFFING_ESCAPE;
+        out[o++] = in[i + k];
+        i += k + 1;
+    }
+
+    return o + EncodeSSE2(in + i, len - i, out + o);
+}
+
+__attribute__((target("avx2"))) static size_t UnescapeAVX2(const char *in, size_t len, char *out)
+{
+    const auto esc = _mm256_set1_epi8(STUFFING_ESCAPE);
+
+    size_t i = 0, o = 0;
+    while (i + 32 <= len)
+    {
+        auto v = _mm256_loadu_si256((const __m256i *)(in + i));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, esc));
+
+        _mm256_storeu_si256((__m256i *)(out + o), v);
+        if (mask == 0)
+        {
+            i += 32;
+            o += 32;
+            continue;
+        }
+
+        int k = __builtin_ctz(mask);
+        o += k;
+        i += k;
+
+        if (i + 1 < len && IsSpecial(in[i + 1]))
+        {
+            i++;
+        }
+
+        out[o++] = in[i++];
+    }
+
+    return o + UnescapeSSE2(in + i, len - i, out + o);
+}
+
+static bool HasAVX2()
+{
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+
+static size_t Escape(const char *in, size_t len, char *out)
+{
+    return HasAVX2() ? EncodeAVX2(in, len, out) : EncodeSSE2(in, len, out);
+}
+
+static size_t Unescape(const char *in, size_t len, char *out)
+{
+    return HasAVX2() ? UnescapeAVX2(in, len, out) : UnescapeSSE2(in, len, out);
+}
+
+#else
+
+static size_t Escape(const char *in, size_t len, char *out)
+{
+    return EncodeScalar(in, len, out);
+}
+
+static size_t Unescape(const char *in, size_t len, char *out)
+{
+    return UnescapeScalar(in, len, out);
+}
+
+#endif
+
+size_t StuffingMaxEncodedSize(size_t len)
+{
+    return len * 2 + 2;
+}
+
+size_t StuffingMaxDecodedSize(size_t len)
+{
+    return len;
+}
+
+size_t StuffingEncode(const char *payload, size_t len, char *out)
+{
+    out[0] = STUFFING_FLAG;
+    auto n = 1 + Escape(payload, len, out + 1);
+    out[n++] = STUFFING_FLAG;
+
+    return n;
+}
+
+size_t StuffingDecode(const char *frame, size_t len, char *out)
+{
+    if (len == 0)
+    {
+        return 0;
+    }
+
+    // drop the first and last unescaped byte (the flags), even if the frame got corrupted
+    size_t first = (len > 1 && frame[0] == STUFFING_ESCAPE && IsSpecial(frame[1])) ? 2 : 1;
+    auto n = Unescape(frame + first, len - first, out);
+
+    return n > 0 ? n - 1 : 0;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stddef.h>
+
+#define STUFFING_FLAG '$'
+#define STUFFING_ESCAPE '/'
+
+// worst case sizes, size output buffers with these before encoding/decoding
+size_t StuffingMaxEncodedSize(size_t len); // every byte escaped plus both flags
+size_t StuffingMaxDecodedSize(size_t len);
+
+// writes flag + escaped payload + flag into out, returns the encoded length
+size_t StuffingEncode(const char *payload, size_t len, char *out);
+
+// removes escaping and both flags, returns the decoded length
+size_t StuffingDecode(const char *frame, size_t len, char *out);
@@ -17,7 +17,27 @@
 #define PARAM_DUPLICATION_DELAY "DD"
 #define PARAM_LOSS_RATE "LP"
 #define PARAM_BASE_PREDICTOR "BasePred"
+#define PARAM_FRAME_CHECK "FCS"
+#define PARAM_FRAMING "framing"
+#define PARAM_FEC "FEC"
+#define PARAM_REPAIR_GROUP "RG"
+#define PARAM_ARQ "ARQ"
+#define PARAM_ACK_EVERY "ackEvery"
+#define PARAM_ACK_DELAY "ackDelay"
+#define PARAM_ADAPTIVE_TIMEOUT "adaptiveTO"
+#define PARAM_MIN_TIMEOUT "minTO"
+#define PARAM_MAX_TIMEOUT "maxTO"
+#define PARAM_TIMEOUT_BACKOFF "backoffTO"
+#define PARAM_ADAPTIVE_WINDOW "adaptiveWS"
+#define PARAM_DUPLEX "duplex"
+#define PARAM_FAST_RETRANSMIT "fastRetransmit"
+#define PARAM_MAX_FRAME_SIZE "maxFrameSize"
+#define PARAM_SEQ_BITS "seqBits"
+#define PARAM_COMPILED_INPUT "compiledInput"
+#define PARAM_INPUT_FILE "inputFile"
 
 #define FRAME_TYPE_NACK 0
 #define FRAME_TYPE_ACK 1
 #define FRAME_TYPE_DATA 2
+#define FRAME_TYPE_REPAIR 3
+#define FRAME_TYPE_CUMULATIVE_ACK 4 // acks every message id up to ackNum
@@ -3,6 +3,7 @@
 #include "SysLogger.h"
 
 #include <fstream>
+#include <sstream>
 #include <string>
 
 Define_Module(Coordinator);
@@ -11,44 +12,154 @@ void Coordinator::initialize()
 {
     EV << "Initializing coordinator, CWD = " << getcwd(0, 0) << endl;
 
-    // delete logs
-    SysDeleteLogs();
+    OpenLogs(this);
 
-    // read config
-    _STD ifstream config("coordinator.txt");
+    // read sessions
+    auto sessionFile = par("sessionFile").stringValue();
+    _STD ifstream config(sessionFile);
     if (!config.is_open())
     {
-        EV << "Failed to open coordinator.txt" << endl;
+        EV << "Failed to open " << sessionFile << endl;
         return;
     }
 
-    // params
-    int nodeId;
-    double startTime;
+    m_Busy.assign(gateSize("out"), false);
+
+    // one session per line: "sender receiver startTime", or "nodeId startTime" with the receiver
+    // left to the wiring
+    _STD string line;
+    int lineNumber = 0;
+    int sessions = 0;
+    while (_STD getline(config, line))
+    {
+        lineNumber++;
+
+        // blank lines and # comments
+        auto first = line.find_first_not_of(" \t\r");
+        if (first == _STD string::npos || line[first] == '#')
+        {
+            continue;
+        }
+
+        double fields[3];
+        int count = 0;
+        _STD istringstream values(line);
+        while (count < 3 && values >> fields[count])
+        {
+            count++;
+        }
 
-    config >> nodeId >> startTime;
+        if (count < 2)
+        {
+            EV << "[Config] Line " << lineNumber << ": expected sender, receiver and start time" << endl;
+            continue;
+        }
 
-    EV << "[Config] Node ID: " << nodeId
-       << ", Start time: " << startTime << endl;
+        int sender = (int)fields[0];
+        int receiver = count == 3 ? (int)fields[1] : -1;
+        double startTime = fields[count - 1];
+
+        EV << "[Config] Node ID: " << sender
+           << ", Receiver: " << receiver
+           << ", Start time: " << startTime << endl;
+
+        sessions += StartSession(sender, receiver, startTime);
+    }
 
     config.close();
 
-    // schedule start time
-    EV << "Sending start message to node " << nodeId << " at time " << startTime << endl;
+    EV << "Coordinator initialized, started " << sessions << " sessions" << endl;
+}
+
+void Coordinator::OpenLogs(cModule *coordinator)
+{
+    if (SysLogIsOpen())
+    {
+        return;
+    }
+
+    // every partition of a parallel run writes its own log
+    auto envir = cSimulation::getActiveEnvir();
+    SysLogSetPartition(envir->getParsimNumPartitions() > 1 ? envir->getParsimProcId() : -1);
+
+    // delete logs
+    SysDeleteLogs();
+
+    // a remote coordinator is a placeholder, the defaults apply if it carries no parameters
+    bool async = !coordinator || !coordinator->hasPar("asyncLog") || coordinator->par("asyncLog").boolValue();
+    bool binary = coordinator && coordinator->hasPar("logFormat") && strcmp(coordinator->par("logFormat").stringValue(), "binary") == 0;
+    SysLogOpen(async, binary);
+}
+
+bool Coordinator::StartSession(int sender, int receiver, double startTime)
+{
+    // out[i] is wired to the node with ID i
+    if (sender < 0 || sender >= gateSize("out"))
+    {
+        EV << "No node " << sender << " to start" << endl;
+        return false;
+    }
+
+    // the receiver is whichever node the sender's port leads to, the file only double checks it.
+    // A node of another parsim partition ends the path as a placeholder without its links, the
+    // file is trusted for it
+    auto senderNode = gate("out", sender)->getPathEndGate()->getOwnerModule();
+    int peer = receiver;
+    if (!senderNode->isPlaceholder())
+    {
+        peer = senderNode->gate("port$o")->getPathEndGate()->getOwnerModule()->par("ID").intValue();
+        if (receiver >= 0 && receiver != peer)
+        {
+            EV << "Node " << sender << " is linked to node " << peer << ", not " << receiver << endl;
+            return false;
+        }
+    }
 
-    // p0 or p1
-    char outPort[3];
-    sprintf(outPort, "p%d", nodeId);
+    // a link carries one session, both directions at once is the duplex parameter
+    bool hasPeer = peer >= 0 && peer < (int)m_Busy.size();
+    if (m_Busy[sender] || (hasPeer && m_Busy[peer]))
+    {
+        EV << "Node " << sender << " or " << peer << " already has a session" << endl;
+        return false;
+    }
+
+    m_Busy[sender] = true;
+    if (hasPeer)
+    {
+        m_Busy[peer] = true;
+    }
+
+    // the start message spends the channel delay (parsim lookahead) on the way
+    auto channel = dynamic_cast<cDelayChannel *>(gate("out", sender)->getChannel());
+    simtime_t delay = startTime;
+    if (channel)
+    {
+        delay -= channel->getDelay();
+    }
+
+    if (delay < SIMTIME_ZERO)
+    {
+        EV << "Start time " << startTime << " of node " << sender << " is before the channel delay, starting late" << endl;
+        delay = SIMTIME_ZERO;
+    }
+
+    // schedule start time
+    EV << "Sending start message to node " << sender << " at time " << startTime << endl;
 
     // send start message
     auto startMsg = new cMessage("start");
     startMsg->setKind(MSG_KIND_START);
-    sendDelayed(startMsg, startTime, outPort);
-
-    EV << "Coordinator initialized, sent start message to port " << outPort << endl;
+    sendDelayed(startMsg, delay, "out", sender);
+    return true;
 }
 
 void Coordinator::handleMessage(cMessage *msg)
 {
     delete msg;
 }
+
+void Coordinator::finish()
+{
+    // make sure every buffered line made it to output.txt
+    SysLogClose();
+}
@@ -1,15 +1,29 @@
 #ifndef __PROJBGDDD_COORDINATOR_H_
 #define __PROJBGDDD_COORDINATOR_H_
 
+#include "Common.h"
+
 #include <omnetpp.h>
+#include <vector>
 
 using namespace omnetpp;
 
 class Coordinator : public cSimpleModule
 {
+  private:
+    _STD vector<bool> m_Busy; // by node ID, nodes already in a session
+
+    bool StartSession(int sender, int receiver, double startTime);
+
   protected:
     virtual void initialize() override;
     virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+
+  public:
+    // opens this process's output.txt (or output.trace) with the coordinator's log settings unless
+    // it is open already. Nodes call it too for parsim partitions the coordinator is not part of
+    static void OpenLogs(cModule *coordinator);
 };
 
 #endif
@@ -0,0 +1,101 @@
+#include "Erasure.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#define ERASURE_LENGTH_BYTES 2
+
+static const char s_HexDigits[] = "0123456789abcdef";
+
+static int HexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+
+    return -1;
+}
+
+// XORs the length-prefixed message into the block, growing it if needed
+static void XorMessage(_STD vector<uint8_t> &block, const _STD string &message)
+{
+    auto len = message.size();
+    if (block.size() < len + ERASURE_LENGTH_BYTES)
+    {
+        block.resize(len + ERASURE_LENGTH_BYTES);
+    }
+
+    block[0] ^= (uint8_t)len;
+    block[1] ^= (uint8_t)(len >> 8);
+
+    auto data = (const uint8_t*)message.data();
+    for (size_t i = 0; i < len; i++)
+    {
+        block[i + ERASURE_LENGTH_BYTES] ^= data[i];
+    }
+}
+
+_STD string ErasureEncode(const _STD vector<const _STD string*> &messages)
+{
+    _STD vector<uint8_t> block(ERASURE_LENGTH_BYTES);
+    for (auto msg : messages)
+    {
+        XorMessage(block, *msg);
+    }
+
+    _STD string out(block.size() * 2, 0);
+    for (size_t i = 0; i < block.size(); i++)
+    {
+        out[i * 2] = s_HexDigits[block[i] >> 4];
+        out[i * 2 + 1] = s_HexDigits[block[i] & 0xF];
+    }
+
+    return out;
+}
+
+bool ErasureRecover(const char *repair, const _STD vector<const _STD string*> &messages, _STD string &missing)
+{
+    auto len = strlen(repair);
+    if (len % 2 != 0 || len < ERASURE_LENGTH_BYTES * 2)
+    {
+        return false;
+    }
+
+    _STD vector<uint8_t> block(len / 2);
+    for (size_t i = 0; i < block.size(); i++)
+    {
+        int hi = HexValue(repair[i * 2]), lo = HexValue(repair[i * 2 + 1]);
+        if (hi < 0 || lo < 0)
+        {
+            return false;
+        }
+
+        block[i] = (uint8_t)(hi << 4 | lo);
+    }
+
+    // cancel out every message we have, what is left is the missing one
+    for (auto msg : messages)
+    {
+        if (msg->size() + ERASURE_LENGTH_BYTES > block.size())
+        {
+            return false;
+        }
+
+        XorMessage(block, *msg);
+    }
+
+    size_t msgLen = block[0] | block[1] << 8;
+    if (msgLen + ERASURE_LENGTH_BYTES > block.size())
+    {
+        return false;
+    }
+
+    missing.assign((const char*)block.data() + ERASURE_LENGTH_BYTES, msgLen);
+    return true;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Common.h"
+
+#include <string>
+#include <vector>
+
+// XOR erasure code over a group of messages, any single message of the group can be rebuilt
+// from the others and the repair block. Messages are length-prefixed and zero padded to the
+// longest one before XORing, the block is hex encoded so it fits a string payload as is
+
+// repair block over all messages of a group
+_STD string ErasureEncode(const _STD vector<const _STD string*> &messages);
+
+// rebuilds the one message missing from the group, false if the block is malformed
+bool ErasureRecover(const char *repair, const _STD vector<const _STD string*> &messages, _STD string &missing);
@@ -0,0 +1,219 @@
+#include "FrameCheck.h"
+
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define FRAMECHECK_X86
+#include <immintrin.h>
+#endif
+
+#define CRC16_CCITT_POLY 0x1021
+#define CRC32_POLY 0xEDB88320 // reflected IEEE 802.3
+#define CRC32C_POLY 0x82F63B78 // reflected Castagnoli
+
+// byte wise XOR of the payload, the original parity byte
+class XorFrameCheck : public FrameCheck
+{
+public:
+    uint32_t Compute(const char *data, size_t len) const override
+    {
+        // chars are sign extended like the original int parity
+        int parity = 0;
+        for (size_t i = 0; i < len; i++)
+        {
+            parity ^= data[i];
+        }
+
+        return (uint32_t)parity;
+    }
+
+    const char *GetName() const override { return "xor"; }
+    int GetWidth() const override { return 8; }
+
+    // output.txt always showed the low nibble of the parity
+    int GetLogWidth() const override { return 4; }
+};
+
+// CRC-16-CCITT (FALSE), one table lookup per byte
+class Crc16FrameCheck : public FrameCheck
+{
+private:
+    uint16_t m_Table[256];
+
+public:
+    Crc16FrameCheck()
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            uint16_t crc = i << 8;
+            for (int bit = 0; bit < 8; bit++)
+            {
+                crc = (crc & 0x8000) ? (crc << 1) ^ CRC16_CCITT_POLY : crc << 1;
+            }
+
+            m_Table[i] = crc;
+        }
+    }
+
+    uint32_t Compute(const char *data, size_t len) const override
+    {
+        uint16_t crc = 0xFFFF;
+        for (size_t i = 0; i < len; i++)
+        {
+            crc = (crc << 8) ^ m_Table[((crc >> 8) ^ (uint8_t)data[i]) & 0xFF];
+        }
+
+        return crc;
+    }
+
+    const char *GetName() const override { return "crc16"; }
+    int GetWidth() const override { return 16; }
+};
+
+// reflected 32 bit CRC, slice-by-8 tables process 8 bytes per iteration
+class Crc32FrameCheck : public FrameCheck
+{
+private:
+    uint32_t m_Table[8][256];
+    const char *m_Name;
+
+protected:
+    uint32_t UpdateSliced(uint32_t crc, const uint8_t *data, size_t len) const
+    {
+        while (len >= 8)
+        {
+            uint32_t lo, hi;
+            memcpy(&lo, data, 4);
+            memcpy(&hi, data + 4, 4);
+            lo ^= crc; // little endian load
+
+            crc = m_Table[7][lo & 0xFF] ^ m_Table[6][(lo >> 8) & 0xFF] ^
+                  m_Table[5][(lo >> 16) & 0xFF] ^ m_Table[4][lo >> 24] ^
+                  m_Table[3][hi & 0xFF] ^ m_Table[2][(hi >> 8) & 0xFF] ^
+                  m_Table[1][(hi >> 16) & 0xFF] ^ m_Table[0][hi >> 24];
+
+            data += 8;
+            len -= 8;
+        }
+
+        while (len--)
+        {
+            crc = (crc >> 8) ^ m_Table[0][(crc ^ *data++) & 0xFF];
+        }
+
+        return crc;
+    }
+
+public:
+    Crc32FrameCheck(uint32_t poly, const char *name) : m_Name(name)
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++)
+            {
+                crc = (crc & 1) ? (crc >> 1) ^ poly : crc >> 1;
+            }
+
+            m_Table[0][i] = crc;
+        }
+
+        for (int i = 0; i < 256; i++)
+        {
+            for (int slice = 1; slice < 8; slice++)
+            {
+                auto prev = m_Table[slice - 1][i];
+                m_Table[slice][i] = (prev >> 8) ^ m_Table[0][prev & 0xFF];
+            }
+        }
+    }
+
+    uint32_t Compute(const char *data, size_t len) const override
+    {
+        return ~UpdateSliced(0xFFFFFFFF, (const uint8_t *)data, len);
+    }
+
+    const char *GetName() const override { return m_Name; }
+    int GetWidth() const override { return 32; }
+};
+
+// CRC-32C, uses the SSE4.2 crc32 instruction when available
+class Crc32cFrameCheck : public Crc32FrameCheck
+{
+private:
+    bool m_Hardware;
+
+#ifdef FRAMECHECK_X86
+    __attribute__((target("sse4.2"))) static uint32_t UpdateHardware(uint32_t crc, const uint8_t *data, size_t len)
+    {
+#ifdef __x86_64__
+        uint64_t crc64 = crc;
+        while (len >= 8)
+        {
+            uint64_t chunk;
+            memcpy(&chunk, data, 8);
+            crc64 = _mm_crc32_u64(crc64, chunk);
+
+            data += 8;
+            len -= 8;
+        }
+
+        crc = (uint32_t)crc64;
+#endif
+
+        while (len--)
+        {
+            crc = _mm_crc32_u8(crc, *data++);
+        }
+
+        return crc;
+    }
+#endif
+
+public:
+    Crc32cFrameCheck() : Crc32FrameCheck(CRC32C_POLY, "crc32c")
+    {
+#ifdef FRAMECHECK_X86
+        m_Hardware = __builtin_cpu_supports("sse4.2");
+#else
+        m_Hardware = false;
+#endif
+    }
+
+    uint32_t Compute(const char *data, size_t len) const override
+    {
+#ifdef FRAMECHECK_X86
+        if (m_Hardware)
+        {
+            return ~UpdateHardware(0xFFFFFFFF, (const uint8_t *)data, len);
+        }
+#endif
+
+        return ~UpdateSliced(0xFFFFFFFF, (const uint8_t *)data, len);
+    }
+};
+
+FrameCheck *FrameCheck::Create(const char *name)
+{
+    if (strcmp(name, "xor") == 0)
+    {
+        return new XorFrameCheck;
+    }
+
+    if (strcmp(name, "crc16") == 0)
+    {
+        return new Crc16FrameCheck;
+    }
+
+    if (strcmp(name, "crc32") == 0)
+    {
+        return new Crc32FrameCheck(CRC32_POLY, "crc32");
+    }
+
+    if (strcmp(name, "crc32c") == 0)
+    {
+        return new Crc32cFrameCheck;
+    }
+
+    return 0;
+}
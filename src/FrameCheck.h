@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// frame check sequence computed over the encoded payload and carried in the packet trailer
+class FrameCheck
+{
+public:
+    virtual ~FrameCheck() {}
+
+    virtual uint32_t Compute(const char *data, size_t len) const = 0;
+    virtual const char *GetName() const = 0;
+
+    // trailer width in bits
+    virtual int GetWidth() const = 0;
+
+    // trailer bits rendered in output.txt
+    virtual int GetLogWidth() const { return GetWidth(); }
+
+    // "xor", "crc16", "crc32" or "crc32c", null if unknown
+    static FrameCheck *Create(const char *name);
+};
@@ -0,0 +1,151 @@
+#include "Framing.h"
+#include "ByteStuffing.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define COBS_MAX_BLOCK 0xFF
+#define LENGTH_DELIMITER ':'
+
+// the original flag/escape scheme, up to 2n + 2 bytes
+class FlagFraming : public Framing
+{
+public:
+    size_t MaxEncodedSize(size_t len) const override { return StuffingMaxEncodedSize(len); }
+    size_t MaxDecodedSize(size_t len) const override { return StuffingMaxDecodedSize(len); }
+
+    size_t Encode(const char *payload, size_t len, char *out) const override
+    {
+        return StuffingEncode(payload, len, out);
+    }
+
+    size_t Decode(const char *frame, size_t len, char *out) const override
+    {
+        return StuffingDecode(frame, len, out);
+    }
+
+    const char *GetName() const override { return "flag"; }
+};
+
+// consistent overhead byte stuffing, removes every zero byte for one byte per 254 at most. The
+// end of the payload string doubles as the zero delimiter, so none is written
+class CobsFraming : public Framing
+{
+public:
+    size_t MaxEncodedSize(size_t len) const override { return len + len / (COBS_MAX_BLOCK - 1) + 1; }
+    size_t MaxDecodedSize(size_t len) const override { return len; }
+
+    size_t Encode(const char *payload, size_t len, char *out) const override
+    {
+        size_t codeIdx = 0, n = 1;
+        uint8_t code = 1;
+
+        for (size_t i = 0; i < len; i++)
+        {
+            if (payload[i] != 0)
+            {
+                out[n++] = payload[i];
+                if (++code != COBS_MAX_BLOCK)
+                {
+                    continue;
+                }
+            }
+
+            // close the block, its code byte is the distance to the next zero
+            out[codeIdx] = (char)code;
+            codeIdx = n++;
+            code = 1;
+        }
+
+        out[codeIdx] = (char)code;
+        return n;
+    }
+
+    size_t Decode(const char *frame, size_t len, char *out) const override
+    {
+        size_t i = 0, n = 0;
+
+        while (i < len)
+        {
+            auto code = (uint8_t)frame[i++];
+            if (code == 0)
+            {
+                break;
+            }
+
+            for (int j = 1; j < code && i < len; j++)
+            {
+                out[n++] = frame[i++];
+            }
+
+            // a full block is not followed by a zero, neither is the last one
+            if (code != COBS_MAX_BLOCK && i < len)
+            {
+                out[n++] = 0;
+            }
+        }
+
+        return n;
+    }
+
+    const char *GetName() const override { return "cobs"; }
+};
+
+// <decimal length>:<payload>, overhead grows with the number of digits only
+class LengthFraming : public Framing
+{
+public:
+    size_t MaxEncodedSize(size_t len) const override { return len + 21; }
+    size_t MaxDecodedSize(size_t len) const override { return len; }
+
+    size_t Encode(const char *payload, size_t len, char *out) const override
+    {
+        auto n = (size_t)sprintf(out, "%u%c", (unsigned)len, LENGTH_DELIMITER);
+        memcpy(out + n, payload, len);
+
+        return n + len;
+    }
+
+    size_t Decode(const char *frame, size_t len, char *out) const override
+    {
+        size_t i = 0, length = 0;
+        while (i < len && frame[i] >= '0' && frame[i] <= '9')
+        {
+            length = length * 10 + (frame[i++] - '0');
+        }
+
+        // skip the delimiter, a damaged prefix is caught by the frame check sequence
+        if (i < len && frame[i] == LENGTH_DELIMITER)
+        {
+            i++;
+        }
+
+        length = length < len - i ? length : len - i;
+        memcpy(out, frame + i, length);
+
+        return length;
+    }
+
+    const char *GetName() const override { return "length"; }
+};
+
+Framing *Framing::Create(const char *name)
+{
+    if (strcmp(name, "flag") == 0)
+    {
+        return new FlagFraming;
+    }
+
+    if (strcmp(name, "cobs") == 0)
+    {
+        return new CobsFraming;
+    }
+
+    if (strcmp(name, "length") == 0)
+    {
+        return new LengthFraming;
+    }
+
+    return 0;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stddef.h>
+
+// how a data payload is delimited on the wire, applied before the frame check sequence
+class Framing
+{
+public:
+    virtual ~Framing() {}
+
+    // worst case sizes, size output buffers with these before encoding/decoding
+    virtual size_t MaxEncodedSize(size_t len) const = 0;
+    virtual size_t MaxDecodedSize(size_t len) const = 0;
+
+    // return the number of bytes written to out, decoding a corrupted frame never overruns
+    virtual size_t Encode(const char *payload, size_t len, char *out) const = 0;
+    virtual size_t Decode(const char *frame, size_t len, char *out) const = 0;
+
+    virtual const char *GetName() const = 0;
+
+    // "flag" (flag/escape byte stuffing), "cobs" or "length", null if unknown
+    static Framing *Create(const char *name);
+};
@@ -0,0 +1,87 @@
+#include "Hamming.h"
+
+#define HAMMING_PARITY_BIT (1u << 31)
+
+static inline bool IsPowerOfTwo(uint32_t x)
+{
+    return (x & (x - 1)) == 0;
+}
+
+static inline uint32_t Parity(uint32_t x)
+{
+    return __builtin_parity(x);
+}
+
+// data bits occupy the codeword positions that are not powers of 2 (3, 5, 6, 7, 9...), the
+// syndrome is the XOR of the positions of all set bits
+static uint32_t Syndrome(const char *data, size_t len, uint32_t *dataParity)
+{
+    uint32_t syndrome = 0, parity = 0;
+    uint32_t pos = 3;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        auto byte = (uint8_t)data[i];
+        parity ^= byte;
+
+        for (int bit = 0; bit < 8; bit++)
+        {
+            if (byte & (1 << bit))
+            {
+                syndrome ^= pos;
+            }
+
+            if (IsPowerOfTwo(++pos))
+            {
+                pos++;
+            }
+        }
+    }
+
+    *dataParity = Parity(parity);
+    return syndrome;
+}
+
+uint32_t HammingEncode(const char *data, size_t len)
+{
+    uint32_t dataParity;
+    auto check = Syndrome(data, len, &dataParity) & ~HAMMING_PARITY_BIT;
+
+    // overall parity makes data + check bits + parity even
+    if (dataParity ^ Parity(check))
+    {
+        check |= HAMMING_PARITY_BIT;
+    }
+
+    return check;
+}
+
+int HammingDecode(char *data, size_t len, uint32_t check)
+{
+    uint32_t dataParity;
+    auto syndrome = (Syndrome(data, len, &dataParity) ^ check) & ~HAMMING_PARITY_BIT;
+    auto overall = dataParity ^ Parity(check);
+
+    if (!overall)
+    {
+        // even parity with a non zero syndrome means two flipped bits
+        return syndrome == 0 ? HAMMING_OK : HAMMING_UNCORRECTABLE;
+    }
+
+    // single error, in the parity bit or in one of the check bits, the data is fine
+    if (syndrome == 0 || IsPowerOfTwo(syndrome))
+    {
+        return HAMMING_OK;
+    }
+
+    // position -> data bit index, skipping the check bit positions before it
+    int checkBitsBefore = 32 - __builtin_clz(syndrome);
+    size_t idx = syndrome - checkBitsBefore - 1;
+    if (idx >= len * 8)
+    {
+        return HAMMING_UNCORRECTABLE;
+    }
+
+    data[idx / 8] ^= 1 << (idx % 8);
+    return HAMMING_CORRECTED;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// systematic extended Hamming (SEC-DED) code over a whole payload, the data bytes go out
+// unchanged and the check bits travel in their own field
+
+enum HAMMING_RESULT
+{
+    HAMMING_OK,
+    HAMMING_CORRECTED,    // single bit error repaired in place
+    HAMMING_UNCORRECTABLE // double bit error detected
+};
+
+// low 31 bits hold the Hamming check bits, bit 31 the overall parity
+uint32_t HammingEncode(const char *data, size_t len);
+
+// checks data against the check bits and repairs a single flipped data bit
+int HammingDecode(char *data, size_t len, uint32_t check);
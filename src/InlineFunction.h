@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Common.h"
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// void() callable stored in place, no allocation as long as the callable fits into Capacity
+// bytes (larger ones fall back to the heap). Not copyable, meant to live inside pooled objects
+template <_STD size_t Capacity>
+class InlineFunction
+{
+private:
+    alignas(_STD max_align_t) unsigned char m_Storage[Capacity];
+    void (*m_Invoke)(void *storage);
+    void (*m_Destroy)(void *storage);
+
+public:
+    InlineFunction() : m_Invoke(0), m_Destroy(0) {}
+    ~InlineFunction() { Reset(); }
+
+    InlineFunction(const InlineFunction &) = delete;
+    InlineFunction &operator=(const InlineFunction &) = delete;
+
+    template <typename F>
+    void Assign(F &&func)
+    {
+        typedef typename _STD decay<F>::type Fn;
+
+        Reset();
+
+        if constexpr (sizeof(Fn) <= Capacity && alignof(Fn) <= alignof(_STD max_align_t))
+        {
+            new (m_Storage) Fn(_STD forward<F>(func));
+            m_Invoke = [](void *storage) { (*(Fn *)storage)(); };
+            m_Destroy = [](void *storage) { ((Fn *)storage)->~Fn(); };
+        }
+        else
+        {
+            *(Fn **)m_Storage = new Fn(_STD forward<F>(func));
+            m_Invoke = [](void *storage) { (**(Fn **)storage)(); };
+            m_Destroy = [](void *storage) { delete *(Fn **)storage; };
+        }
+    }
+
+    // destroys the callable and everything it captured
+    void Reset()
+    {
+        if (m_Destroy)
+        {
+            m_Destroy(m_Storage);
+            m_Invoke = m_Destroy = 0;
+        }
+    }
+
+    void operator()() { m_Invoke(m_Storage); }
+    explicit operator bool() const { return m_Invoke != 0; }
+};
@@ -0,0 +1,269 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+    m_Data = 0;
+    m_Size = 0;
+    m_Writable = false;
+
+#ifdef _WIN32
+    m_File = INVALID_HANDLE_VALUE;
+    m_Mapping = 0;
+#else
+    m_Fd = -1;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::OpenRead(const char *path)
+{
+    Close();
+
+    m_File = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (m_File == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    GetFileSizeEx(m_File, &size);
+
+    m_Size = (size_t)size.QuadPart;
+    m_Writable = false;
+
+    if (!Map())
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+bool MappedFile::OpenWrite(const char *path, size_t size)
+{
+    Close();
+
+    m_File = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, 0, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0);
+    if (m_File == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    m_Writable = true;
+    if (!Resize(size))
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+bool MappedFile::Resize(size_t size)
+{
+    if (!m_Writable)
+    {
+        return false;
+    }
+
+    Unmap();
+
+    LARGE_INTEGER pos;
+    pos.QuadPart = (LONGLONG)size;
+    if (!SetFilePointerEx(m_File, pos, 0, FILE_BEGIN) || !SetEndOfFile(m_File))
+    {
+        return false;
+    }
+
+    m_Size = size;
+    return Map();
+}
+
+bool MappedFile::Map()
+{
+    // empty files cannot be mapped
+    if (m_Size == 0)
+    {
+        return true;
+    }
+
+    m_Mapping = CreateFileMappingA(m_File, 0, m_Writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, 0);
+    if (!m_Mapping)
+    {
+        return false;
+    }
+
+    m_Data = (char *)MapViewOfFile(m_Mapping, m_Writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, m_Size);
+    return m_Data != 0;
+}
+
+void MappedFile::Unmap()
+{
+    if (m_Data)
+    {
+        UnmapViewOfFile(m_Data);
+        m_Data = 0;
+    }
+
+    if (m_Mapping)
+    {
+        CloseHandle(m_Mapping);
+        m_Mapping = 0;
+    }
+}
+
+void MappedFile::Close()
+{
+    Unmap();
+
+    if (m_File != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_File);
+        m_File = INVALID_HANDLE_VALUE;
+    }
+
+    m_Size = 0;
+}
+
+bool MappedFile::IsOpen() const
+{
+    return m_File != INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool MappedFile::OpenRead(const char *path)
+{
+    Close();
+
+    m_Fd = open(path, O_RDONLY);
+    if (m_Fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+    fstat(m_Fd, &st);
+
+    m_Size = (size_t)st.st_size;
+    m_Writable = false;
+
+    if (!Map())
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+bool MappedFile::OpenWrite(const char *path, size_t size)
+{
+    Close();
+
+    m_Fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_Fd < 0)
+    {
+        return false;
+    }
+
+    m_Writable = true;
+    if (!Resize(size))
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+bool MappedFile::Resize(size_t size)
+{
+    if (!m_Writable)
+    {
+        return false;
+    }
+
+    Unmap();
+
+    if (ftruncate(m_Fd, (off_t)size) != 0)
+    {
+        return false;
+    }
+
+    m_Size = size;
+    return Map();
+}
+
+bool MappedFile::Map()
+{
+    // empty files cannot be mapped
+    if (m_Size == 0)
+    {
+        return true;
+    }
+
+    auto data = mmap(0, m_Size, m_Writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, m_Fd, 0);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    m_Data = (char *)data;
+    return true;
+}
+
+void MappedFile::Unmap()
+{
+    if (m_Data)
+    {
+        munmap(m_Data, m_Size);
+        m_Data = 0;
+    }
+}
+
+void MappedFile::Close()
+{
+    Unmap();
+
+    if (m_Fd >= 0)
+    {
+        close(m_Fd);
+        m_Fd = -1;
+    }
+
+    m_Size = 0;
+}
+
+bool MappedFile::IsOpen() const
+{
+    return m_Fd >= 0;
+}
+
+#endif
+
+char *MappedFile::GetData() const
+{
+    return m_Data;
+}
+
+size_t MappedFile::GetSize() const
+{
+    return m_Size;
+}
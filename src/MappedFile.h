@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stddef.h>
+
+// thin cross-platform wrapper around a memory-mapped file
+class MappedFile
+{
+private:
+    char *m_Data;
+    size_t m_Size;
+    bool m_Writable;
+
+#ifdef _WIN32
+    void *m_File;
+    void *m_Mapping;
+#else
+    int m_Fd;
+#endif
+
+    bool Map();
+    void Unmap();
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    // maps an existing file read-only
+    bool OpenRead(const char *path);
+
+    // creates (or truncates) a file of the given size and maps it read-write
+    bool OpenWrite(const char *path, size_t size);
+
+    // grows or shrinks a writable mapping, data pointer may change
+    bool Resize(size_t size);
+
+    void Close();
+
+    bool IsOpen() const;
+    char *GetData() const;
+    size_t GetSize() const;
+};
@@ -0,0 +1,98 @@
+#include "MessageSource.h"
+#include "Aggregation.h"
+
+VectorMessageSource::VectorMessageSource(const _STD vector<InputMessage> &messages) : m_Messages(messages)
+{
+    m_Next = 0;
+}
+
+bool VectorMessageSource::Next(NodeMessageData &data)
+{
+    if (m_Next == m_Messages.size())
+    {
+        return false;
+    }
+
+    auto &msg = m_Messages[m_Next];
+    data.message.assign(msg.message.data(), msg.message.size());
+    data.id = (int)m_Next++;
+    data.flags = msg.flags;
+    data.unframedLength = -1;
+    return true;
+}
+
+bool VectorMessageSource::AtEnd() const
+{
+    return m_Next == m_Messages.size();
+}
+
+WorkloadMessageSource::WorkloadMessageSource(const WorkloadFile &workload, bool stuffed) : m_Workload(workload)
+{
+    m_Stuffed = stuffed;
+    m_Next = 0;
+}
+
+bool WorkloadMessageSource::Next(NodeMessageData &data)
+{
+    if (m_Next == m_Workload.GetCount())
+    {
+        return false;
+    }
+
+    auto message = m_Stuffed ? m_Workload.GetStuffedMessage(m_Next) : m_Workload.GetMessage(m_Next);
+    data.message.assign(message.data(), message.size());
+    data.unframedLength = m_Stuffed ? (int)m_Workload.GetMessage(m_Next).size() : -1;
+    data.flags = m_Workload.GetFlags(m_Next);
+    data.id = m_Next++;
+    return true;
+}
+
+bool WorkloadMessageSource::AtEnd() const
+{
+    return m_Next == m_Workload.GetCount();
+}
+
+AggregatingMessageSource::AggregatingMessageSource(MessageSource *source, size_t maxFrameSize) : m_Source(source)
+{
+    m_MaxFrameSize = maxFrameSize;
+    m_HasPending = false;
+    m_Frames = 0;
+}
+
+AggregatingMessageSource::~AggregatingMessageSource()
+{
+    delete m_Source;
+}
+
+bool AggregatingMessageSource::Next(NodeMessageData &data)
+{
+    if (!m_HasPending && !(m_HasPending = m_Source->Next(m_Pending)))
+    {
+        return false;
+    }
+
+    data.message.clear();
+    data.id = m_Frames++;
+    data.flags = {};
+    data.unframedLength = -1;
+
+    // the first message goes in even if it is larger than a frame
+    int count = 0;
+    do
+    {
+        AggregateAppend(data.message, m_Pending.message, count++);
+        data.flags.modification |= m_Pending.flags.modification;
+        data.flags.loss |= m_Pending.flags.loss;
+        data.flags.duplication |= m_Pending.flags.duplication;
+        data.flags.delay |= m_Pending.flags.delay;
+
+        m_HasPending = m_Source->Next(m_Pending);
+    } while (m_HasPending && data.message.size() + 1 + AggregateSize(m_Pending.message) <= m_MaxFrameSize);
+
+    return true;
+}
+
+bool AggregatingMessageSource::AtEnd() const
+{
+    return !m_HasPending && m_Source->AtEnd();
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Common.h"
+#include "Node.h"
+#include "Workload.h"
+
+#include <stddef.h>
+#include <vector>
+
+// hands the sender its input one frame at a time, in order, so it only holds the frames in flight
+class MessageSource
+{
+public:
+    virtual ~MessageSource() {}
+
+    // copies the next message into data, false once the input is exhausted
+    virtual bool Next(NodeMessageData &data) = 0;
+    virtual bool AtEnd() const = 0;
+};
+
+// messages the node read up front
+class VectorMessageSource : public MessageSource
+{
+private:
+    const _STD vector<InputMessage> &m_Messages;
+    size_t m_Next;
+
+public:
+    VectorMessageSource(const _STD vector<InputMessage> &messages);
+    bool Next(NodeMessageData &data) override;
+    bool AtEnd() const override;
+};
+
+// messages of a compiled workload, copied straight out of the mapping
+class WorkloadMessageSource : public MessageSource
+{
+private:
+    const WorkloadFile &m_Workload;
+    bool m_Stuffed; // hand out the pre-stuffed messages
+    int m_Next;
+
+public:
+    WorkloadMessageSource(const WorkloadFile &workload, bool stuffed);
+    bool Next(NodeMessageData &data) override;
+    bool AtEnd() const override;
+};
+
+// joins consecutive messages of another source into frames of up to maxFrameSize payload bytes, a
+// frame carries the channel errors of all its messages
+class AggregatingMessageSource : public MessageSource
+{
+private:
+    MessageSource *m_Source; // owned
+    size_t m_MaxFrameSize;
+    NodeMessageData m_Pending; // first message of the next frame
+    bool m_HasPending;
+    int m_Frames;
+
+public:
+    AggregatingMessageSource(MessageSource *source, size_t maxFrameSize);
+    ~AggregatingMessageSource();
+    bool Next(NodeMessageData &data) override;
+    bool AtEnd() const override;
+};
@@ -0,0 +1,104 @@
+#include "NetDuplex.h"
+#include "Node.h"
+#include "Packet_m.h"
+#include "SysLogger.h"
+
+NetDuplex::NetDuplex(Node *node) : NetEntity(node), NetSender(node), NetReceiver(node)
+{
+    NODE_LOG_INFO("NetDuplex constructed");
+
+    m_PiggybackedAcks = 0;
+    m_AllAcked = false;
+}
+
+void NetDuplex::ReceivePacket(Packet *packet, uint32_t *recvTrailer)
+{
+    auto frameType = packet->getFrameType();
+    if (frameType != FRAME_TYPE_DATA && frameType != FRAME_TYPE_REPAIR)
+    {
+        NetSender::ReceivePacket(packet, recvTrailer);
+        return;
+    }
+
+    NetReceiver::ReceivePacket(packet, recvTrailer);
+
+    // the ack number is outside the frame check, like the other header fields
+    if (packet->getPiggybackAck() >= 0)
+    {
+        NODE_LOG("Piggybacked ACK %d", packet->getPiggybackAck());
+        ReceiveAck(FRAME_TYPE_CUMULATIVE_ACK, packet->getSeqNum(), packet->getPiggybackAck());
+    }
+}
+
+void NetDuplex::ReceiveTimerEvent(NodeMessageData *data)
+{
+    // retransmission timers carry their message, the delayed ACK timer nothing
+    if (data == 0)
+    {
+        NetReceiver::ReceiveTimerEvent(data);
+        return;
+    }
+
+    NetSender::ReceiveTimerEvent(data);
+}
+
+void NetDuplex::SendPacket(TransmissionContext *ctx)
+{
+    // acks are not window frames
+    if (ctx->data == 0)
+    {
+        NetEntity::SendPacket(ctx);
+        return;
+    }
+
+    NetSender::SendPacket(ctx);
+}
+
+void NetDuplex::OnPostProcess(TransmissionContext *ctx)
+{
+    if (ctx->data == 0)
+    {
+        NetReceiver::OnPostProcess(ctx);
+        return;
+    }
+
+    // the frame is about to leave, take along whatever the peer is owed
+    int seqNum, id;
+    if (TakePendingAck(seqNum, id))
+    {
+        ctx->packet->setPiggybackAck(id);
+        m_PiggybackedAcks++;
+
+        // syslog
+        auto record = CreateTraceRecord(SYSTRACE_EVENT_ACK_SENT);
+        record.seqNum = seqNum;
+        record.flags = ctx->data->flags.loss ? SYSTRACE_FLAG_LOST : 0;
+        SysLogEvent(record);
+    }
+
+    NetSender::OnPostProcess(ctx);
+}
+
+void NetDuplex::OnAllAcked()
+{
+    // the peer may still be sending, the run ends once neither side has anything left
+    if (!m_AllAcked)
+    {
+        NODE_LOG_INFO("All messages acked");
+        m_AllAcked = true;
+    }
+}
+
+int NetDuplex::GetType()
+{
+    return NET_ENTITY_TYPE_DUPLEX;
+}
+
+void NetDuplex::Finish()
+{
+    NetEntity::Finish();
+    NetSender::RecordStatistics();
+    NetReceiver::RecordStatistics();
+
+    m_Node->recordScalar("piggybackedAcks", m_PiggybackedAcks);
+}
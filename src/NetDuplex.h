@@ -0,0 +1,25 @@
+#pragma once
+
+#include "NetReceiver.h"
+#include "NetSender.h"
+
+// sends its own input while receiving the peer's, both share the processing pipeline and
+// pending cumulative ACKs ride on outgoing data frames
+class NetDuplex : public NetSender, public NetReceiver
+{
+private:
+    int m_PiggybackedAcks;
+    bool m_AllAcked;
+
+protected:
+    void SendPacket(TransmissionContext *ctx) override;
+    void OnPostProcess(TransmissionContext *ctx) override;
+    void OnAllAcked() override;
+
+public:
+    NetDuplex(Node *node);
+    void ReceivePacket(Packet *packet, uint32_t *recvTrailer = 0) override;
+    void ReceiveTimerEvent(NodeMessageData *data) override;
+    int GetType() override;
+    void Finish() override;
+};
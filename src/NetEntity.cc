@@ -1,28 +1,79 @@
 #include "NetEntity.h"
+#include "FrameCheck.h"
+#include "Framing.h"
+#include "Hamming.h"
 #include "Node.h"
 #include "Packet_m.h"
+#include "ScheduledEvent.h"
+#include "SysTrace.h"
 
 #include <omnetpp.h>
-#include "NetSender.h"
 
 NetEntity::NetEntity(Node *node) : m_Node(node), m_NodeId(node->GetNodeId())
 {
     m_NextSendTime = 0;
+    m_FecCorrected = m_FecUncorrectable = 0;
+    m_FramedPayloadBytes = m_FramingOverheadBytes = 0;
+    m_FramesSent = 0;
+
+    // a timeout wins ties with frames arriving at the same time, as when timers were scheduled at start
+    m_TimerEvent = new cMessage("timer", MSG_KIND_TIMER);
+    m_TimerEvent->setSchedulingPriority(-1);
+    m_TimerEventTime = -1;
+
+    // payload framing
+    auto framing = m_Node->GetParams()->framing.c_str();
+    m_Framing = Framing::Create(framing);
+    if (!m_Framing)
+    {
+        NODE_LOG_ERROR("Unknown framing %s, falling back to flag", framing);
+        m_Framing = Framing::Create("flag");
+    }
+
+    // frame check sequence
+    auto frameCheck = m_Node->GetParams()->frameCheck.c_str();
+    m_FrameCheck = FrameCheck::Create(frameCheck);
+    if (!m_FrameCheck)
+    {
+        NODE_LOG_ERROR("Unknown frame check %s, falling back to xor", frameCheck);
+        m_FrameCheck = FrameCheck::Create("xor");
+    }
 }
 
 NetEntity::~NetEntity()
 {
-    for (auto ctx : m_TransmissionContexts)
+    // pending ones included, the node is going away
+    for (auto event : m_Events)
     {
-        delete ctx;
+        m_Node->cancelAndDelete(event);
     }
+
+    m_Node->cancelAndDelete(m_TimerEvent);
+
+    delete m_FrameCheck;
+    delete m_Framing;
 }
 
-void NetEntity::ReceivePacket(Packet *packet, int *recvParity)
+template <typename F>
+void NetEntity::ExecuteScheduled(long delay, F &&func)
 {
-    if (recvParity)
+    auto event = AcquireEvent();
+    event->callback.Assign(_STD forward<F>(func));
+
+    m_Node->scheduleAt(simTime() + simtime_t(delay, SIMTIME_MS), event);
+}
+
+void NetEntity::ReceivePacket(Packet *packet, uint32_t *recvTrailer)
+{
+    if (packet->getFrameType() == FRAME_TYPE_DATA && m_Node->GetParams()->fec && packet->getHasFec())
+    {
+        // repair single bit errors before checking the frame, if the sender added check bits
+        CorrectPacket(packet);
+    }
+
+    if (recvTrailer)
     {
-        *recvParity = CalculateParity(packet->getPayload());
+        *recvTrailer = CalculateTrailer(packet->getPayload());
     }
 
     if (packet->getFrameType() == FRAME_TYPE_DATA)
@@ -32,18 +83,35 @@ void NetEntity::ReceivePacket(Packet *packet, int *recvParity)
     }
 }
 
-void NetEntity::SendPacket(TransmissionContext *ctx, PTransmissionCallback onPostProcess, PTransmissionCallback onPreProcess)
+void NetEntity::SendPacket(TransmissionContext *ctx)
 {
     auto packet = ctx->packet;
     auto data = ctx->data;
 
+    m_FramesSent++;
+
     if (packet->getFrameType() == FRAME_TYPE_DATA)
     {
-        // escape payload
-        EncodePacket(packet);
+        // frame payload, messages of a compiled workload may be stuffed already
+        if (data && data->unframedLength >= 0)
+        {
+            m_FramedPayloadBytes += data->unframedLength;
+            m_FramingOverheadBytes += data->message.size() - data->unframedLength;
+        }
+        else
+        {
+            EncodePacket(packet);
+        }
 
-        // calculate parity
-        packet->setParity(CalculateParity(packet->getPayload()));
+        // calculate frame check sequence
+        packet->setTrailer(CalculateTrailer(packet->getPayload()));
+
+        // error correction bits, the modification below is what they protect against
+        if (m_Node->GetParams()->fec)
+        {
+            packet->setFec(HammingEncode(packet->getPayload(), strlen(packet->getPayload())));
+            packet->setHasFec(true);
+        }
 
         if (data)
         {
@@ -71,29 +139,48 @@ void NetEntity::SendPacket(TransmissionContext *ctx, PTransmissionCallback onPos
             }
         }
     }
+    else if (packet->getFrameType() == FRAME_TYPE_REPAIR)
+    {
+        // the hex repair block has no flag/escape bytes, only the frame check sequence is needed
+        packet->setTrailer(CalculateTrailer(packet->getPayload()));
+    }
 
-    auto postProcessed = [this, ctx, packet, onPostProcess, data]()
+    auto postProcessed = [this, ctx]()
     {
+        auto packet = ctx->packet;
+        auto data = ctx->data;
+
         NODE_LOG("Sending packet seqNum=%d, ackNum=%d, payload=%s", packet->getSeqNum(), packet->getAckNum(), packet->getPayload());
 
-        // execute onSent callback, typically start timer
-        if (onPostProcess)
+        // the packet is gone once sent, keep what the transmission logs need
+        if (data)
         {
-            (*onPostProcess)(ctx);
-            delete onPostProcess;
+            ctx->payload = packet->getPayload();
+            ctx->trailer = packet->getTrailer();
+        }
+
+        // typically start timer
+        if (ctx->hooks & TRANSMISSION_HOOK_POST_PROCESS)
+        {
+            OnPostProcess(ctx);
         }
 
         if ((data && data->flags.loss) || ctx->ackLost)
         {
             // log after delay
             NODE_LOG("Packet lost");
+
+            delete packet;
+            ReleaseTransmissionContext(ctx);
             return;
         }
 
         // calc delay
         auto delay = CalculateDelay(data);
         NODE_LOG("Sending packet with channel delay %ld", delay);
-        m_Node->sendDelayed(packet, simtime_t(delay, SIMTIME_MS), "port$o");
+        // the channel delay (parsim lookahead) is part of TD
+        auto linkDelay = m_Node->GetParams()->linkDelay;
+        m_Node->sendDelayed(packet, simtime_t(delay, SIMTIME_MS) - linkDelay, "port$o");
 
         // duplicated packet?
         if (data && data->flags.duplication)
@@ -104,31 +191,37 @@ void NetEntity::SendPacket(TransmissionContext *ctx, PTransmissionCallback onPos
 
             NODE_LOG("Duplicating packet with delay %ld", delay);
 
-            m_Node->sendDelayed(dup, simtime_t(delay, SIMTIME_MS), "port$o");
+            m_Node->sendDelayed(dup, simtime_t(delay, SIMTIME_MS) - linkDelay, "port$o");
 
             // log after delay
             auto dupLog = [this, ctx]()
             {
-                ((NetSender*)this)->SysLogTransmission(ctx, 0);
+                OnDuplicateSent(ctx);
+                ReleaseTransmissionContext(ctx);
             };
 
+            ctx->refs++;
             ExecuteScheduled(dupDelay, dupLog);
         }
+
+        ReleaseTransmissionContext(ctx);
     };
 
     // execute post process callback, and get delay of pre-process as well
     long preprocessDelay;
     ExecuteScheduled(GetAndUpdateProcessingDelay(&preprocessDelay), postProcessed);
 
-    // execute pre-process callback
-    if (onPreProcess)
+    // execute pre-process hook
+    if (ctx->hooks & TRANSMISSION_HOOK_PRE_PROCESS)
     {
-        auto preProcessed = [onPreProcess, ctx]()
+        auto preProcessed = [this, ctx]()
         {
-            (*onPreProcess)(ctx);
-            delete onPreProcess;
+            OnPreProcess(ctx);
+            ReleaseTransmissionContext(ctx);
         };
 
+        ctx->refs++;
+
         if (preprocessDelay > 0)
         {
             ExecuteScheduled(preprocessDelay, preProcessed);
@@ -158,29 +251,62 @@ float NetEntity::GetSimTimeF()
     return GetSimTime() / 1000.0f;
 }
 
-TransmissionContext *NetEntity::CreateTransmissionContext(Packet *packet, NodeMessageData *data)
+TransmissionContext *NetEntity::CreateTransmissionContext(Packet *packet, NodeMessageData *data, int hooks)
 {
-    auto ctx = new TransmissionContext;
+    auto ctx = m_TransmissionContexts.Create();
     ctx->packet = packet;
     ctx->data = data;
+    ctx->trailer = 0;
     ctx->modifiedBitIdx = -1;
     ctx->nextDuplicateType = data && data->flags.duplication ? 1 : 0;
     ctx->ackLost = false;
-
-    m_TransmissionContexts.push_back(ctx);
+    ctx->ackLogged = false;
+    ctx->hooks = hooks;
+    ctx->refs = 1; // held by the send pipeline until the packet leaves
 
     return ctx;
 }
 
-int NetEntity::CalculateParity(const char *payload)
+void NetEntity::ReleaseTransmissionContext(TransmissionContext *ctx)
+{
+    if (--ctx->refs == 0)
+    {
+        if (ctx->hooks & TRANSMISSION_HOOK_RELEASE)
+        {
+            OnRelease(ctx);
+        }
+
+        m_TransmissionContexts.Destroy(ctx);
+    }
+}
+
+SysTraceRecord NetEntity::CreateTraceRecord(int type)
 {
-    int parity = 0;
-    for (int i = 0, len = strlen(payload); i < len; i++)
+    SysTraceRecord record = {};
+    record.time = GetSimTime();
+    record.node = m_NodeId;
+    record.modified = -1;
+    record.type = type;
+
+    return record;
+}
+
+int NetEntity::GetSeqModulus()
+{
+    // seqBits sets the sequence space. Otherwise go-back-n needs one more than the window to tell
+    // new frames from retransmissions, selective repeat twice the window
+    auto params = m_Node->GetParams();
+    if (params->seqBits > 0)
     {
-        parity ^= payload[i];
+        return 1 << params->seqBits;
     }
 
-    return parity;
+    return params->arqMode == ARQ_MODE_SELECTIVE_REPEAT ? 2 * params->windowSize : params->windowSize + 1;
+}
+
+uint32_t NetEntity::CalculateTrailer(const char *payload)
+{
+    return m_FrameCheck->Compute(payload, strlen(payload));
 }
 
 long NetEntity::GetAndUpdateProcessingDelay(long *preprocessDelay)
@@ -219,53 +345,158 @@ long NetEntity::CalculateDelay(NodeMessageData *data)
     return delay;
 }
 
-void NetEntity::ExecuteScheduled(long delay, _STD function<void()> func)
+ScheduledEvent *NetEntity::AcquireEvent()
 {
-    auto msg = new cMessage("scheduled");
-    msg->setKind(MSG_KIND_SCHEDULED);
-    msg->setContextPointer(new _STD function<void()>(func));
+    if (m_EventPool.empty())
+    {
+        auto event = new ScheduledEvent;
+        m_Events.push_back(event);
+        return event;
+    }
 
-    m_Node->scheduleAt(simTime() + simtime_t(delay, SIMTIME_MS), msg);
+    auto event = m_EventPool.back();
+    m_EventPool.pop_back();
+    return event;
+}
+
+void NetEntity::ReceiveScheduledEvent(ScheduledEvent *event)
+{
+    event->callback();
+
+    // release the captures now, the event itself goes back to the pool
+    event->callback.Reset();
+    m_EventPool.push_back(event);
 }
 
 void NetEntity::EncodePacket(Packet *packet)
 {
-    // flag = $
-    // esc = /
+    auto payload = packet->getPayload();
+    auto len = strlen(payload);
+
+    auto out = ReserveFrameBuffer(m_Framing->MaxEncodedSize(len) + 1);
+    auto n = m_Framing->Encode(payload, len, out);
+    out[n] = 0;
+
+    m_FramedPayloadBytes += len;
+    m_FramingOverheadBytes += n - len;
+
+    packet->setPayload(out);
+}
+
+void NetEntity::DecodePacket(Packet *packet)
+{
+    auto payload = packet->getPayload();
+    auto len = strlen(payload);
+
+    // remove framing
+    auto out = ReserveFrameBuffer(m_Framing->MaxDecodedSize(len) + 1);
+    auto n = m_Framing->Decode(payload, len, out);
+    out[n] = 0;
+
+    packet->setPayload(out);
+}
+
+void NetEntity::CorrectPacket(Packet *packet)
+{
+    auto payload = packet->getPayload();
+    auto len = strlen(payload);
+
+    auto buf = ReserveFrameBuffer(len + 1);
+    memcpy(buf, payload, len + 1);
 
-    auto payload = _STD string(packet->getPayload());
-    for (int i = 0; i < payload.size(); i++)
+    switch (HammingDecode(buf, len, packet->getFec()))
     {
-        if (payload[i] == '$' || payload[i] == '/')
-        {
-            payload.insert(i, 1, '/');
-            i++;
-        }
+    case HAMMING_CORRECTED:
+        NODE_LOG("FEC corrected payload %s -> %s", payload, buf);
+        packet->setPayload(buf);
+        m_FecCorrected++;
+        break;
+
+    case HAMMING_UNCORRECTABLE:
+        NODE_LOG_WARN("FEC detected an uncorrectable error");
+        m_FecUncorrectable++;
+        break;
     }
+}
 
-    payload = "$" + payload + "$";
-    packet->setPayload(payload.c_str());
+char *NetEntity::ReserveFrameBuffer(size_t size)
+{
+    // only ever grows, so steady state framing does not allocate
+    if (m_FrameBuffer.size() < size)
+    {
+        m_FrameBuffer.resize(size);
+    }
+
+    return m_FrameBuffer.data();
 }
 
-void NetEntity::DecodePacket(Packet *packet)
+void NetEntity::Finish()
+{
+    // pool growth is the only allocation the pipeline makes, it levels off with the frames in flight
+    m_Node->recordScalar("framesSent", m_FramesSent);
+    m_Node->recordScalar("scheduledEventsAllocated", m_Events.size());
+    m_Node->recordScalar("transmissionContextsAllocated", m_TransmissionContexts.GetCapacity());
+
+    if (m_FramedPayloadBytes > 0)
+    {
+        m_Node->recordScalar("framedPayloadBytes", m_FramedPayloadBytes);
+        m_Node->recordScalar("framingOverheadBytes", m_FramingOverheadBytes);
+    }
+
+    if (m_Node->GetParams()->fec)
+    {
+        m_Node->recordScalar("fecCorrectedFrames", m_FecCorrected);
+        m_Node->recordScalar("fecUncorrectableFrames", m_FecUncorrectable);
+    }
+}
+
+void NetEntity::StartTimer(TimerHandle *timer, long delay)
+{
+    auto expiry = GetSimTime() + delay;
+    m_TimerWheel.Start(timer, expiry);
+
+    // timers mostly expire in start order, only an earlier one moves the event
+    if (!m_TimerEvent->isScheduled() || expiry < m_TimerEventTime)
+    {
+        ScheduleTimerEvent(expiry);
+    }
+}
+
+void NetEntity::CancelTimer(TimerHandle *timer)
+{
+    // the event stays, at worst it fires with nothing due and moves on
+    m_TimerWheel.Cancel(timer);
+}
+
+void NetEntity::ReceiveTimerTick()
 {
-    auto payload = _STD string(packet->getPayload());
+    auto now = GetSimTime();
+    while (auto timer = m_TimerWheel.PopExpired(now))
+    {
+        ReceiveTimerEvent((NodeMessageData *)timer->context);
+    }
 
-    // remove escaping
-    for (int i = 0; i < payload.size() - 1; i++)
+    auto next = m_TimerWheel.GetNextExpiry();
+    if (next != -1)
     {
-        if (payload[i] == '/')
+        ScheduleTimerEvent(next);
+    }
+}
+
+void NetEntity::ScheduleTimerEvent(long time)
+{
+    if (m_TimerEvent->isScheduled())
+    {
+        if (time == m_TimerEventTime)
         {
-            if (payload[i + 1] == '$' || payload[i + 1] == '/')
-            {
-                payload.erase(i, 1);
-                //i++;
-            }
+            return;
         }
+
+        m_Node->cancelEvent(m_TimerEvent);
     }
 
-    payload = payload.substr(1, payload.size() - 2);
-    packet->setPayload(payload.c_str());
+    m_TimerEventTime = time;
+    m_Node->scheduleAt(simtime_t(time, SIMTIME_MS), m_TimerEvent);
 }
 
 void NetEntity::ReceiveTimerEvent(NodeMessageData *data)
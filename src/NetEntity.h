@@ -1,21 +1,37 @@
 #pragma once
 
-#include <functional>
+#include <stdint.h>
+#include <string>
 #include <vector>
 
 #include "Common.h"
+#include "SlabAllocator.h"
+#include "TimerWheel.h"
 
 class Node;
 class Packet;
+class FrameCheck;
+class Framing;
+class ScheduledEvent;
 struct NodeMessageData;
 struct TransmissionContext;
+struct SysTraceRecord;
 
-typedef _STD function<void(TransmissionContext*)> TransmissionCallback, *PTransmissionCallback;
+namespace omnetpp { class cMessage; }
 
 enum NET_ENTITY_TYPE
 {
     NET_ENTITY_TYPE_SENDER,
-    NET_ENTITY_TYPE_RECEIVER
+    NET_ENTITY_TYPE_RECEIVER,
+    NET_ENTITY_TYPE_DUPLEX
+};
+
+// which NetEntity hooks a transmission runs
+enum TRANSMISSION_HOOK
+{
+    TRANSMISSION_HOOK_PRE_PROCESS = 1 << 0, // OnPreProcess once processing of the frame starts
+    TRANSMISSION_HOOK_POST_PROCESS = 1 << 1, // OnPostProcess right before the frame leaves
+    TRANSMISSION_HOOK_RELEASE = 1 << 2 // OnRelease once nothing refers to the context anymore
 };
 
 struct TransmissionContext
@@ -23,47 +39,100 @@ struct TransmissionContext
     Packet* packet;
     NodeMessageData* data;
 
+    // snapshot of the sent frame for the transmission logs
+    _STD string payload;
+    uint32_t trailer;
+
     int modifiedBitIdx;
     int nextDuplicateType;
     bool ackLost;
+    bool ackLogged; // false for acks of frames the receiver did not deliver
+    int hooks; // TRANSMISSION_HOOK_* flags
+    int refs; // pending callbacks, released back to the slab at 0
 };
 
 class NetEntity
 {
 private:
     long m_NextSendTime;
-    _STD vector<TransmissionContext*> m_TransmissionContexts;
+    SlabAllocator<TransmissionContext> m_TransmissionContexts;
+    _STD vector<char> m_FrameBuffer; // scratch space for encoding/decoding
+    Framing *m_Framing;
+
+    // scheduled events are recycled instead of allocated per callback
+    _STD vector<ScheduledEvent*> m_EventPool; // idle events
+    _STD vector<ScheduledEvent*> m_Events; // every event created, for cleanup
+
+    // retransmission timers, one self message fires at the earliest expiry
+    TimerWheel m_TimerWheel;
+    omnetpp::cMessage *m_TimerEvent;
+    long m_TimerEventTime;
+
+    void ScheduleTimerEvent(long time);
+
+    // bytes-on-wire accounting of the framing
+    long m_FramedPayloadBytes;
+    long m_FramingOverheadBytes;
+
+    // frames through the send pipeline, against the pooled objects backing them
+    long m_FramesSent;
 
     void EncodePacket(Packet *packet);
     void DecodePacket(Packet *packet);
-    int CalculateParity(const char *payload);
+    char* ReserveFrameBuffer(size_t size);
+    uint32_t CalculateTrailer(const char *payload);
+    void CorrectPacket(Packet *packet);
     long GetAndUpdateProcessingDelay(long* preprocessDelay = 0);
     long CalculateDelay(NodeMessageData *data);
-    void ExecuteScheduled(long delay, _STD function<void()> func);
+    ScheduledEvent* AcquireEvent();
+    template <typename F> void ExecuteScheduled(long delay, F &&func);
 
 protected:
     Node *const m_Node;
     const int m_NodeId;
+    FrameCheck *m_FrameCheck;
+
+    // forward error correction stats
+    int m_FecCorrected;
+    int m_FecUncorrectable;
 
-    virtual void SendPacket(TransmissionContext* ctx, PTransmissionCallback onPostProcess = 0, PTransmissionCallback onPreProcess = 0);
+    virtual void SendPacket(TransmissionContext* ctx);
+
+    // transmission hooks, see TRANSMISSION_HOOK
+    virtual void OnPreProcess(TransmissionContext* ctx) {}
+    virtual void OnPostProcess(TransmissionContext* ctx) {}
+    virtual void OnDuplicateSent(TransmissionContext* ctx) {}
+    virtual void OnRelease(TransmissionContext* ctx) {}
     bool Probability(const char *param);
     long GetSimTime(); // in ms
     float GetSimTimeF(); // in s
-    TransmissionContext* CreateTransmissionContext(Packet* packet, NodeMessageData* data = 0);
+    TransmissionContext* CreateTransmissionContext(Packet* packet, NodeMessageData* data = 0, int hooks = 0);
+    void ReleaseTransmissionContext(TransmissionContext* ctx);
+    SysTraceRecord CreateTraceRecord(int type);
+    int GetSeqModulus();
+
+    // delay in ms, ReceiveTimerEvent gets the handle's context once it expires
+    void StartTimer(TimerHandle *timer, long delay);
+    void CancelTimer(TimerHandle *timer);
 
 public:
     NetEntity(Node *node);
-    ~NetEntity();
+    virtual ~NetEntity();
 
-    virtual void ReceivePacket(Packet *packet, int *recvParity = 0);
+    virtual void ReceivePacket(Packet *packet, uint32_t *recvTrailer = 0);
     virtual void ReceiveTimerEvent(NodeMessageData *data);
+    void ReceiveTimerTick();
+    void ReceiveScheduledEvent(ScheduledEvent *event);
     virtual int GetType() = 0;
+
+    // end of simulation, record statistics
+    virtual void Finish();
 };
 
-#define MAKE_PACKET(name, frameType, seqNum, payload, parity, ackNum) \
+#define MAKE_PACKET(name, frameType, seqNum, payload, trailer, ackNum) \
     auto name = new Packet(0, MSG_KIND_PACKET);                       \
     name->setFrameType(frameType);                                    \
     name->setSeqNum(seqNum);                                          \
     name->setPayload(payload);                                        \
-    name->setParity(parity);                                          \
+    name->setTrailer(trailer);                                        \
     name->setAckNum(ackNum);
\ No newline at end of file
@@ -1,72 +1,449 @@
 #include "NetReceiver.h"
+#include "Aggregation.h"
+#include "Erasure.h"
 #include "Node.h"
 #include "Packet_m.h"
 #include "SysLogger.h"
 
+#include <stdlib.h>
+
 NetReceiver::NetReceiver(Node *node) : NetEntity(node)
 {
-    NODE_LOG("NetReceiver constructed");
+    NODE_LOG_INFO("NetReceiver constructed");
 
     m_LastSeqNum = -1;
+    m_NextId = 0;
+    m_NacksSent = 0;
+    m_RecoveredFrames = 0;
+    m_DeliveredFrames = 0;
+    m_DeliveredMessages = 0;
+    m_AckFrames = 0;
+    m_PendingAcks = 0;
+
+    // selective repeat reorder buffer, a ring of WS slots starting at the window base
+    m_ExpectedSeqNum = 0;
+    m_ReorderHead = 0;
+    if (m_Node->GetParams()->arqMode == ARQ_MODE_SELECTIVE_REPEAT)
+    {
+        m_ReorderBuffer.resize(m_Node->GetParams()->windowSize);
+    }
 }
 
-void NetReceiver::ReceivePacket(Packet *packet, int *recvParity)
+void NetReceiver::ReceivePacket(Packet *packet, uint32_t *recvTrailer)
 {
-    // calc parity before decoding
-    int newParity;
-    NetEntity::ReceivePacket(packet, &newParity);
+    // calc frame check sequence before decoding
+    uint32_t newTrailer;
+    NetEntity::ReceivePacket(packet, &newTrailer);
 
-    NODE_LOG("Received packet content=%s parity=%d at t=%ld", packet->getPayload(), packet->getParity(), GetSimTime());
+    bool error = packet->getTrailer() != newTrailer;
+    if (packet->getFrameType() == FRAME_TYPE_REPAIR)
+    {
+        ReceiveRepairFrame(packet, error);
+        return;
+    }
+
+    ReceiveDataFrame(packet, error);
+}
+
+void NetReceiver::ReceiveDataFrame(Packet *packet, bool error)
+{
+    NODE_LOG("Received packet content=%s trailer=%u at t=%ld", packet->getPayload(), packet->getTrailer(), GetSimTime());
 
     // syslog
-    SysLog("At : %.2f Node : %d Received packet with seqNum : %d, payload = %s",
-           GetSimTimeF(), m_NodeId, packet->getSeqNum(), packet->getPayload());
+    auto record = CreateTraceRecord(SYSTRACE_EVENT_FRAME_RECEIVED);
+    record.seqNum = packet->getSeqNum();
+    SysLogEvent(record, packet->getPayload());
+
+    // check frame check sequence
+    if (error)
+    {
+        NODE_LOG_WARN("Frame check failed");
+    }
+    else if (m_Node->GetParams()->repairGroup > 0)
+    {
+        // keep it until its repair group is delivered
+        m_RepairBuffer.emplace(packet->getAckNum(), BufferedFrame{packet->getPayload(), packet->getSeqNum()});
+    }
 
-    // check parity
-    bool error = packet->getParity() != newParity;
+    // a duplex node holds its acks for outgoing data frames
+    if (!error && (m_Node->GetParams()->ackEvery > 1 || m_Node->GetParams()->duplex))
+    {
+        AcceptCumulative(packet);
+        return;
+    }
+
+    int seqNum = packet->getSeqNum();
+    int id = packet->getAckNum();
+    bool selectiveRepeat = m_Node->GetParams()->arqMode == ARQ_MODE_SELECTIVE_REPEAT;
     if (error)
     {
-        NODE_LOG("Parity check failed");
+        // frames are acked one by one with selective repeat, go-back-n only logs the NACK of the
+        // frame expected next
+        SendAck(FRAME_TYPE_NACK, seqNum, id, selectiveRepeat || IsNextFrame(seqNum, id));
+        return;
     }
 
-    // do we actually send?
-    bool lost = int(m_Node->uniform(0, 100)) < (int)m_Node->GetParams()->lossRate;  // Probability(PARAM_LOSS_RATE);
-    auto onPostProcessCallback = [this, error, packet, lost](TransmissionContext *ctx)
+    if (selectiveRepeat)
+    {
+        ReorderFrame(packet);
+        SendAck(FRAME_TYPE_ACK, seqNum, id);
+        return;
+    }
+
+    // go-back-n delivers in order only, on arrival
+    if (IsNextFrame(seqNum, id))
+    {
+        m_LastSeqNum = seqNum;
+        m_NextId = id + 1;
+        m_DeliveredFrames++;
+        m_DeliveredMessages += SplitMessages(packet->getPayload());
+
+        SendAck(FRAME_TYPE_ACK, seqNum, id);
+        DeliverBuffered();
+    }
+    else if (m_Node->GetParams()->repairGroup > 0)
+    {
+        // held in the repair buffer, the ack keeps the sender from resending it
+        SendAck(FRAME_TYPE_ACK, seqNum, id, false);
+    }
+    else if (m_NextId > 0)
+    {
+        // dropped, repeat the ack of the last frame delivered. Every ack then covers the frames
+        // before it as well
+        SendAck(FRAME_TYPE_ACK, m_LastSeqNum, m_NextId - 1, false);
+    }
+}
+
+void NetReceiver::AcceptCumulative(Packet *packet)
+{
+    // delivered on arrival, the ack no longer carries the in-order check through processing
+    int nextId = m_NextId;
+    bool selectiveRepeat = m_Node->GetParams()->arqMode == ARQ_MODE_SELECTIVE_REPEAT;
+    if (selectiveRepeat)
+    {
+        ReorderFrame(packet);
+    }
+    else if (IsNextFrame(packet->getSeqNum(), packet->getAckNum()))
+    {
+        m_LastSeqNum = packet->getSeqNum();
+        m_NextId = packet->getAckNum() + 1;
+        m_DeliveredFrames++;
+        m_DeliveredMessages += SplitMessages(packet->getPayload());
+        DeliverBuffered();
+    }
+
+    if (m_NextId == nextId)
     {
-        int prevSeqNum = packet->getSeqNum() - 1;
-        if (prevSeqNum == -1)
+        // selective repeat still acks a buffered frame on its own so it is not resent, go-back-n
+        // repeats the last cumulative ACK
+        if (selectiveRepeat)
         {
-            prevSeqNum = m_Node->GetParams()->windowSize - 1;
+            SendAck(FRAME_TYPE_ACK, packet->getSeqNum(), packet->getAckNum());
         }
-
-        if (m_LastSeqNum == -1 || m_LastSeqNum == prevSeqNum)
+        else
         {
-            if (!error)
-            {
-                m_LastSeqNum = packet->getSeqNum();
-            }
-
-            // syslog
-            SysLog("At time : %.2f Node : %d Sending %s with number : %d, loss : %s",
-                   GetSimTimeF(), m_NodeId, error ? "NACK" : "ACK", packet->getSeqNum(), lost ? "YES" : "NO");
+            SendCumulativeAck();
         }
-    };
+
+        return;
+    }
+
+    // without an explicit count a duplex node waits for data frames or the timer
+    auto ackEvery = m_Node->GetParams()->ackEvery;
+    m_PendingAcks += m_NextId - nextId;
+    if (m_PendingAcks >= ackEvery && (ackEvery > 1 || !m_Node->GetParams()->duplex))
+    {
+        SendCumulativeAck();
+    }
+    else if (!m_AckTimer.IsActive())
+    {
+        StartTimer(&m_AckTimer, (long)(m_Node->GetParams()->ackDelay * 1000));
+    }
+}
+
+void NetReceiver::SendCumulativeAck()
+{
+    // nothing delivered yet
+    if (m_NextId == 0)
+    {
+        return;
+    }
+
+    CancelTimer(&m_AckTimer);
+    m_PendingAcks = 0;
+
+    SendAck(FRAME_TYPE_CUMULATIVE_ACK, GetDeliveredSeqNum(), m_NextId - 1);
+}
+
+bool NetReceiver::TakePendingAck(int &seqNum, int &id)
+{
+    if (m_PendingAcks == 0)
+    {
+        return false;
+    }
+
+    CancelTimer(&m_AckTimer);
+    m_PendingAcks = 0;
+
+    seqNum = GetDeliveredSeqNum();
+    id = m_NextId - 1;
+    return true;
+}
+
+int NetReceiver::GetDeliveredSeqNum()
+{
+    if (m_Node->GetParams()->arqMode == ARQ_MODE_SELECTIVE_REPEAT)
+    {
+        return (m_ExpectedSeqNum + GetSeqModulus() - 1) % GetSeqModulus();
+    }
+
+    return m_LastSeqNum;
+}
+
+void NetReceiver::SendAck(int frameType, int seqNum, int id, bool logged)
+{
+    // do we actually send?
+    bool lost = int(m_Node->uniform(0, 100)) < (int)m_Node->GetParams()->lossRate;  // Probability(PARAM_LOSS_RATE);
 
     // send ack/nack
     if (!lost)
     {
-        NODE_LOG("Sending %s", error ? "NACK" : "ACK");
+        NODE_LOG("Sending %s", frameType == FRAME_TYPE_NACK ? "NACK" : "ACK");
     }
 
-    MAKE_PACKET(ack, error ? FRAME_TYPE_NACK : FRAME_TYPE_ACK, packet->getSeqNum(), "", -1, packet->getAckNum());
+    if (frameType == FRAME_TYPE_NACK)
+    {
+        m_NacksSent++;
+    }
+
+    m_AckFrames++;
 
-    auto ctx = CreateTransmissionContext(ack);
+    MAKE_PACKET(ack, frameType, seqNum, "", 0, id);
+
+    // logged once processing is done, the ack carries everything it needs
+    auto ctx = CreateTransmissionContext(ack, 0, TRANSMISSION_HOOK_POST_PROCESS);
     ctx->ackLost = lost;
+    ctx->ackLogged = logged;
 
-    SendPacket(ctx, new TransmissionCallback(onPostProcessCallback));
+    SendPacket(ctx);
+}
+
+void NetReceiver::ReceiveTimerEvent(NodeMessageData *data)
+{
+    // the delayed ACK timer is the only one the receiver arms
+    NODE_LOG("Delayed ACK timer expired at t=%ld", GetSimTime());
+    SendCumulativeAck();
+}
+
+void NetReceiver::OnPostProcess(TransmissionContext *ctx)
+{
+    // frames were delivered on arrival, acks of frames held or dropped out of order stay out of the log
+    if (!ctx->ackLogged)
+    {
+        return;
+    }
+
+    // syslog
+    auto ack = ctx->packet;
+    auto record = CreateTraceRecord(SYSTRACE_EVENT_ACK_SENT);
+    record.seqNum = ack->getSeqNum();
+    record.flags = (ack->getFrameType() == FRAME_TYPE_NACK ? SYSTRACE_FLAG_NACK : 0) | (ctx->ackLost ? SYSTRACE_FLAG_LOST : 0);
+    SysLogEvent(record);
+}
+
+void NetReceiver::ReorderFrame(Packet *packet)
+{
+    auto windowSize = m_Node->GetParams()->windowSize;
+    auto modulus = GetSeqModulus();
+
+    // already delivered frames fall behind the window, they only need the ack again
+    int offset = (packet->getSeqNum() - m_ExpectedSeqNum + modulus) % modulus;
+    if (offset >= windowSize)
+    {
+        NODE_LOG("Frame seqNum=%d outside the receive window, already delivered", packet->getSeqNum());
+        return;
+    }
+
+    auto &slot = m_ReorderBuffer[(m_ReorderHead + offset) % windowSize];
+    if (!slot.filled)
+    {
+        slot.message = packet->getPayload();
+        slot.id = packet->getAckNum();
+        slot.filled = true;
+    }
+
+    // hand over the in-order run from the window base
+    for (auto head = &m_ReorderBuffer[m_ReorderHead]; head->filled; head = &m_ReorderBuffer[m_ReorderHead])
+    {
+        NODE_LOG_INFO("Delivering message %d: %s", head->id, head->message.c_str());
+
+        head->filled = false;
+        m_NextId = head->id + 1;
+        m_DeliveredFrames++;
+        m_DeliveredMessages += SplitMessages(head->message.c_str());
+        m_ExpectedSeqNum = (m_ExpectedSeqNum + 1) % modulus;
+        m_ReorderHead = (m_ReorderHead + 1) % windowSize;
+    }
+
+    PruneRepairBuffer();
+}
+
+void NetReceiver::ReceiveRepairFrame(Packet *packet, bool error)
+{
+    if (error)
+    {
+        NODE_LOG_WARN("Repair frame failed the frame check, dropped");
+        return;
+    }
+
+    // payload = <group size>:<repair block>
+    char *block;
+    int count = strtol(packet->getPayload(), &block, 10);
+    if (count <= 0 || *block != ':')
+    {
+        NODE_LOG_ERROR("Malformed repair frame %s", packet->getPayload());
+        return;
+    }
+
+    int firstId = packet->getAckNum();
+    int missingId = -1;
+
+    _STD vector<const _STD string*> messages;
+    for (int id = firstId; id < firstId + count; id++)
+    {
+        auto it = m_RepairBuffer.find(id);
+        if (it != m_RepairBuffer.end())
+        {
+            messages.push_back(&it->second.message);
+            continue;
+        }
+
+        if (missingId != -1)
+        {
+            NODE_LOG("Repair frame for messages %d..%d ignored, more than one frame missing", firstId, firstId + count - 1);
+            return;
+        }
+
+        missingId = id;
+    }
+
+    // nothing missing, or the group was delivered already
+    if (missingId < m_NextId)
+    {
+        return;
+    }
+
+    _STD string message;
+    if (!ErasureRecover(block + 1, messages, message))
+    {
+        NODE_LOG_ERROR("Malformed repair block for messages %d..%d", firstId, firstId + count - 1);
+        return;
+    }
+
+    NODE_LOG_INFO("Rebuilt message %d from repair frame: %s", missingId, message.c_str());
+    m_RecoveredFrames++;
+
+    // handle it as if it arrived intact, the sender gets its ACK without a timeout
+    auto seqNum = (packet->getSeqNum() + missingId - firstId) % GetSeqModulus();
+    MAKE_PACKET(rebuilt, FRAME_TYPE_DATA, seqNum, message.c_str(), 0, missingId);
+    ReceiveDataFrame(rebuilt, false);
+
+    delete rebuilt;
+}
+
+bool NetReceiver::IsNextFrame(int seqNum, int id)
+{
+    // repair groups are tracked by message id, which does not wrap like the sequence number
+    if (m_Node->GetParams()->repairGroup > 0)
+    {
+        return id == m_NextId;
+    }
+
+    // the one after the last frame delivered. A resent copy of a delivered frame is a full window
+    // behind, the extra sequence number keeps it from matching
+    return seqNum == (m_LastSeqNum + 1) % GetSeqModulus();
+}
+
+void NetReceiver::DeliverBuffered()
+{
+    if (m_Node->GetParams()->repairGroup <= 0)
+    {
+        return;
+    }
+
+    // frames that arrived ahead of a rebuilt one were acked already, the sender will not resend them
+    for (auto it = m_RepairBuffer.find(m_NextId); it != m_RepairBuffer.end(); it = m_RepairBuffer.find(m_NextId))
+    {
+        NODE_LOG_INFO("Delivering buffered message %d: %s", m_NextId, it->second.message.c_str());
+
+        m_LastSeqNum = it->second.seqNum;
+        m_NextId++;
+        m_DeliveredFrames++;
+        m_DeliveredMessages += SplitMessages(it->second.message.c_str());
+    }
+
+    PruneRepairBuffer();
+}
+
+int NetReceiver::SplitMessages(const char *payload)
+{
+    if (m_Node->GetParams()->maxFrameSize <= 0)
+    {
+        return 1;
+    }
+
+    // an aggregated frame carries several messages
+    _STD vector<_STD string> messages;
+    AggregateSplit(payload, messages);
+    for (auto &message : messages)
+    {
+        NODE_LOG("Split message: %s", message.c_str());
+    }
+
+    return (int)messages.size();
+}
+
+void NetReceiver::PruneRepairBuffer()
+{
+    auto repairGroup = m_Node->GetParams()->repairGroup;
+    if (repairGroup <= 0)
+    {
+        return;
+    }
+
+    // groups before the current one are complete
+    m_RepairBuffer.erase(m_RepairBuffer.begin(), m_RepairBuffer.lower_bound(m_NextId - m_NextId % repairGroup));
 }
 
 int NetReceiver::GetType()
 {
     return NET_ENTITY_TYPE_RECEIVER;
-}
\ No newline at end of file
+}
+
+void NetReceiver::Finish()
+{
+    NetEntity::Finish();
+    RecordStatistics();
+}
+
+void NetReceiver::RecordStatistics()
+{
+    // every NACK costs the sender a retransmission
+    m_Node->recordScalar("nacksSent", m_NacksSent);
+    m_Node->recordScalar("ackFramesSent", m_AckFrames);
+
+    if (m_Node->GetParams()->repairGroup > 0)
+    {
+        m_Node->recordScalar("recoveredFrames", m_RecoveredFrames);
+    }
+
+    // in-order deliveries, goodput in messages per simulated second
+    auto time = GetSimTimeF();
+    m_Node->recordScalar("deliveredFrames", m_DeliveredFrames);
+    if (m_Node->GetParams()->maxFrameSize > 0)
+    {
+        m_Node->recordScalar("deliveredMessages", m_DeliveredMessages);
+    }
+
+    m_Node->recordScalar("goodput", time > 0 ? m_DeliveredMessages / time : 0.0);
+}
@@ -2,13 +2,66 @@
 
 #include "NetEntity.h"
 
-class NetReceiver : public NetEntity
+#include <map>
+#include <string>
+#include <vector>
+
+// correctly received frame of an open repair group
+struct BufferedFrame
+{
+    _STD string message;
+    int seqNum;
+};
+
+// frame held in the selective repeat reorder buffer
+struct ReorderSlot
+{
+    _STD string message;
+    int id;
+    bool filled;
+
+    ReorderSlot() : id(0), filled(false) {}
+};
+
+class NetReceiver : public virtual NetEntity
 {
 private:
     int m_LastSeqNum;
+    int m_NextId; // message id expected next
+    int m_NacksSent;
+    int m_RecoveredFrames;
+    int m_DeliveredFrames;
+    int m_DeliveredMessages; // frames split back into messages when aggregated
+    int m_AckFrames; // ACKs and NACKs put on the reverse channel
+    int m_PendingAcks; // in-order frames no cumulative ACK covers yet
+    TimerHandle m_AckTimer; // delayed cumulative ACK
+    int m_ExpectedSeqNum; // selective repeat receive window base
+    int m_ReorderHead; // reorder buffer slot of m_ExpectedSeqNum
+    _STD vector<ReorderSlot> m_ReorderBuffer;
+    _STD map<int, BufferedFrame> m_RepairBuffer; // by message id
+
+    void ReceiveDataFrame(Packet *packet, bool error);
+    void ReceiveRepairFrame(Packet *packet, bool error);
+    bool IsNextFrame(int seqNum, int id);
+    void DeliverBuffered();
+    void PruneRepairBuffer();
+    void ReorderFrame(Packet *packet);
+    void AcceptCumulative(Packet *packet);
+    void SendCumulativeAck();
+    void SendAck(int frameType, int seqNum, int id, bool logged = true);
+    int SplitMessages(const char *payload); // once the frame is delivered in order
+    int GetDeliveredSeqNum();
+
+protected:
+    // hands the pending cumulative ACK to an outgoing data frame instead
+    bool TakePendingAck(int &seqNum, int &id);
+    void RecordStatistics();
+    void OnPostProcess(TransmissionContext *ctx) override;
 
 public:
     NetReceiver(Node *node);
-    void ReceivePacket(Packet *packet, int *recvParity = 0) override;
+    void ReceivePacket(Packet *packet, uint32_t *recvTrailer = 0) override;
+    void ReceiveTimerEvent(NodeMessageData *data) override;
     int GetType() override;
+    void Finish() override;
 };
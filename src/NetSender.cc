@@ -1,14 +1,37 @@
 #include "NetSender.h"
+#include "Erasure.h"
+#include "FrameCheck.h"
 #include "Node.h"
 #include "Packet_m.h"
 #include "SysLogger.h"
 
 #include <omnetpp.h>
-#include <bitset>
 
-NetSender::NetSender(Node *node) : NetEntity(node)
+NetSender::NetSender(Node *node) : NetEntity(node),
+    m_RttEstimator((long)(node->GetParams()->timeoutInterval * 1000),
+                   (long)(node->GetParams()->minTimeout * 1000),
+                   (long)(node->GetParams()->maxTimeout * 1000)),
+    m_RttVector("rtt"), m_TimeoutVector("rto"), m_WindowVector("cwnd"),
+    m_LatencyVector("deliveryLatency")
 {
-    NODE_LOG("NetSender constructed");
+    NODE_LOG_INFO("NetSender constructed");
+
+    m_RetransmittedFrames = 0;
+    m_RepairFramesSent = 0;
+    m_Backoff = 0;
+    m_TimeoutVector.record(GetTimeout() / 1000.0);
+
+    // sequence numbers are sized for WS, the largest window, unless seqBits is set
+    m_CongestionWindow = 1;
+    m_RecoveryEnd = -1;
+    m_WindowDecreases = 0;
+    m_SuppressedNacks = 0;
+    m_LatencySum = 0;
+    m_LatencyCount = 0;
+    if (node->GetParams()->adaptiveWindow)
+    {
+        m_WindowVector.record(GetWindowSize());
+    }
 
     // init window
     ConstructWindow();
@@ -17,54 +40,97 @@ NetSender::NetSender(Node *node) : NetEntity(node)
     SendWindow();
 }
 
-void NetSender::ReceivePacket(Packet *packet, int *recvParity)
+NetSender::~NetSender()
+{
+    delete m_Source;
+}
+
+void NetSender::ReceivePacket(Packet *packet, uint32_t *recvTrailer)
 {
-    NetEntity::ReceivePacket(packet, recvParity);
+    NetEntity::ReceivePacket(packet, recvTrailer);
+    ReceiveAck(packet->getFrameType(), packet->getSeqNum(), packet->getAckNum());
+}
 
+void NetSender::ReceiveAck(int frameType, int seqNum, int ackNum)
+{
     // check if we received an ack/nack
-    auto frameType = packet->getFrameType();
-    if (frameType != FRAME_TYPE_ACK && frameType != FRAME_TYPE_NACK)
+    if (frameType != FRAME_TYPE_ACK && frameType != FRAME_TYPE_NACK && frameType != FRAME_TYPE_CUMULATIVE_ACK)
     {
-        NODE_LOG("ERROR Received packet with invalid frame type %d", frameType);
+        NODE_LOG_ERROR("Received packet with invalid frame type %d", frameType);
         return;
     }
 
-    NODE_LOG("Received %s at t=%ld", packet->getFrameType() == FRAME_TYPE_ACK ? "ACK" : "NACK", GetSimTime());
+    NODE_LOG("Received %s at t=%ld", frameType == FRAME_TYPE_NACK ? "NACK" : "ACK", GetSimTime());
 
     // are we going to advance window?
-    if (frameType == FRAME_TYPE_ACK)
+    if (frameType != FRAME_TYPE_NACK)
     {
-        // mark acked and cancel timer
-        int ackNum = packet->getAckNum();
+        // acks from before the window base refer to frames the ring may have dropped already
+        if (ackNum < m_WindowBase)
+        {
+            NODE_LOG("Stale ACK %d, window base is %d", ackNum, m_WindowBase);
+            return;
+        }
 
-        auto &wnd = m_Window[ackNum];
-        wnd.acked = true;
-        CancelTimer(wnd.timer);
+        // mark acked and cancel timer, a cumulative ack covers the whole window up to its number.
+        // So does any go-back-n ack without repair groups, the receiver only acks frames it
+        // delivered in order
+        auto params = m_Node->GetParams();
+        int firstId = ackNum;
+        if (frameType == FRAME_TYPE_CUMULATIVE_ACK || (params->arqMode == ARQ_MODE_GO_BACK_N && params->repairGroup <= 0))
+        {
+            firstId = m_WindowBase;
+        }
 
-        // advance window if needed
-        if (ackNum == m_WindowBase)
+        // the frame that triggered the ack measures the round trip
+        AddRttSample(GetFrame(ackNum));
+
+        int ackedFrames = 0;
+        for (int id = firstId; id <= ackNum; id++)
         {
-            NODE_LOG("Advancing window base to %d", ++ackNum);
+            auto &wnd = GetFrame(id);
+            ackedFrames += !wnd.acked;
+            if (!wnd.delivered)
+            {
+                auto latency = (GetSimTime() - wnd.firstSentTime) / 1000.0;
+                m_LatencyVector.record(latency);
+                m_LatencySum += latency;
+                m_LatencyCount++;
+                wnd.delivered = true;
+            }
+
+            wnd.acked = true;
+            wnd.nackRetransmitted = false;
+            CancelTimer(&wnd);
+        }
+
+        GrowWindow(ackedFrames);
 
-            // should we terminate?
-            bool fullyAcked = true;
-            for (auto &wnd : m_Window)
+        // advance window if needed
+        if (firstId == m_WindowBase)
+        {
+            // slide past frames acked out of order as well when the receiver holds on to them, with
+            // selective repeat or while it rebuilds a lost frame from a repair frame. A go-back-n
+            // receiver drops them
+            bool buffered = params->arqMode == ARQ_MODE_SELECTIVE_REPEAT || params->repairGroup > 0;
+            int lastId = ackNum;
+            ackNum = m_WindowBase;
+            while (ackNum < m_LoadedFrames && GetFrame(ackNum).acked && (buffered || ackNum <= lastId))
             {
-                if (!wnd.acked)
-                {
-                    fullyAcked = false;
-                    break;
-                }
+                ackNum++;
             }
 
-            if (fullyAcked)
+            NODE_LOG("Advancing window base to %d", ackNum);
+
+            // should we terminate? frames acked past the base may still wait in the receiver's
+            // buffers, only a base past the last frame means everything was delivered
+            if (ackNum == m_LoadedFrames && m_Source->AtEnd())
             {
-                NODE_LOG("All messages acked, terminating");
-                m_Node->endSimulation();
+                OnAllAcked();
                 return;
             }
 
-            m_WindowBase = _STD min(ackNum, (int)m_Window.size() - 1);
+            m_WindowBase = ackNum;
 
             // log window
             LogWindow();
@@ -76,8 +142,61 @@ void NetSender::ReceivePacket(Packet *packet, int *recvParity)
     else
     {
         // syslog
-        SysLog("At : %.2f, Node : %d, [%s] NACK for seq_number : %d",
-               GetSimTimeF(), m_NodeId, "received", packet->getSeqNum());
+        auto record = CreateTraceRecord(SYSTRACE_EVENT_NACK_RECEIVED);
+        record.seqNum = seqNum;
+        SysLogEvent(record);
+
+        int id = ackNum;
+        if (id < m_WindowBase || id >= m_WindowBase + m_Node->GetParams()->windowSize || GetFrame(id).acked)
+        {
+            return;
+        }
+
+        auto &wnd = GetFrame(id);
+
+        // duplicated or delayed copies NACK the same transmission again
+        if (wnd.nackRetransmitted)
+        {
+            NODE_LOG("Duplicate NACK for message %d suppressed", id);
+            m_SuppressedNacks++;
+            return;
+        }
+
+        ShrinkWindow();
+
+        // selective repeat resends the damaged frame right away, go-back-n waits for the timeout
+        // unless fastRetransmit is set
+        bool selectiveRepeat = m_Node->GetParams()->arqMode == ARQ_MODE_SELECTIVE_REPEAT;
+        if (!selectiveRepeat && !m_Node->GetParams()->fastRetransmit)
+        {
+            return;
+        }
+
+        NODE_LOG("Retransmitting message %d after NACK", id);
+
+        // errors only hit the first transmission, as after a timeout
+        wnd.data.flags = {false, false, false, false};
+        wnd.nackRetransmitted = true;
+
+        if (selectiveRepeat)
+        {
+            SendFrame(wnd);
+            return;
+        }
+
+        // the receiver dropped everything after the damaged frame
+        WithdrawFrames();
+
+        int end = _STD min(m_WindowBase + GetWindowSize(), m_LoadedFrames);
+        for (int i = id; i < end; i++)
+        {
+            if (GetFrame(i).sent && !GetFrame(i).acked)
+            {
+                SendFrame(GetFrame(i));
+            }
+        }
+
+        SendWindow();
     }
 }
 
@@ -85,14 +204,14 @@ void NetSender::ReceiveTimerEvent(NodeMessageData *data)
 {
     if (data == 0)
     {
-        NODE_LOG("ERROR NodeMessageData null at sender");
+        NODE_LOG_ERROR("NodeMessageData null at sender");
         return;
     }
 
     NetEntity::ReceiveTimerEvent(data);
 
     // check if already acked or out of window
-    auto &wnd = m_Window[data->id];
+    auto &wnd = GetFrame(data->id);
     if (wnd.acked ||
         data->id < m_WindowBase ||
         data->id >= m_WindowBase + m_Node->GetParams()->windowSize)
@@ -101,12 +220,39 @@ void NetSender::ReceiveTimerEvent(NodeMessageData *data)
         return;
     }
 
+    // go-back-n resends the whole window on the base frame's timeout. Later frames go out with it,
+    // their timers run out behind copies still waiting in the send pipeline
+    if (m_Node->GetParams()->arqMode == ARQ_MODE_GO_BACK_N && data->id != m_WindowBase)
+    {
+        NODE_LOG("Timer event received for message %d, waiting for window base %d", data->id, m_WindowBase);
+        return;
+    }
+
     // syslog
-    SysLog("Time out event at time : %.2f, Node : %d, for frame with seq_num = %d",
-           GetSimTimeF(), m_NodeId, wnd.seqNum);
+    auto record = CreateTraceRecord(SYSTRACE_EVENT_TIMEOUT);
+    record.seqNum = wnd.seqNum;
+    SysLogEvent(record);
 
     // remove all errors from timedout packet
     data->flags = {false, false, false, false};
+    wnd.nackRetransmitted = false;
+
+    if (m_Node->GetParams()->timeoutBackoff && GetTimeout() < m_Node->GetParams()->maxTimeout * 1000)
+    {
+        m_Backoff++;
+        m_TimeoutVector.record(GetTimeout() / 1000.0);
+    }
+
+    ShrinkWindow();
+
+    if (m_Node->GetParams()->arqMode == ARQ_MODE_SELECTIVE_REPEAT)
+    {
+        // only the frame that timed out
+        SendFrame(wnd);
+        return;
+    }
+
+    WithdrawFrames();
 
     // resend window
     SendWindow(true);
@@ -117,40 +263,123 @@ int NetSender::GetType()
     return NET_ENTITY_TYPE_SENDER;
 }
 
+void NetSender::OnAllAcked()
+{
+    NODE_LOG_INFO("All messages acked, terminating");
+    SysLogFlush();
+    m_Node->endSimulation();
+}
+
+void NetSender::Finish()
+{
+    NetEntity::Finish();
+    RecordStatistics();
+}
+
+void NetSender::RecordStatistics()
+{
+    m_Node->recordScalar("retransmittedFrames", m_RetransmittedFrames);
+
+    if (m_RttEstimator.HasSample())
+    {
+        m_Node->recordScalar("smoothedRtt", m_RttEstimator.GetSmoothedRtt() / 1000.0);
+    }
+
+    m_Node->recordScalar("rto", GetTimeout() / 1000.0);
+    m_Node->recordScalar("suppressedNacks", m_SuppressedNacks);
+
+    if (m_LatencyCount > 0)
+    {
+        m_Node->recordScalar("meanDeliveryLatency", m_LatencySum / m_LatencyCount);
+    }
+
+    if (m_Node->GetParams()->adaptiveWindow)
+    {
+        m_Node->recordScalar("windowDecreases", m_WindowDecreases);
+    }
+
+    if (m_Node->GetParams()->repairGroup > 0)
+    {
+        m_Node->recordScalar("repairFramesSent", m_RepairFramesSent);
+    }
+}
+
 void NetSender::SendWindow(bool force)
 {
-    auto windowSize = m_Node->GetParams()->windowSize;
-    int endIdx = _STD min(m_WindowBase + windowSize, (int)m_Window.size());
-    auto end = m_Window.begin() + endIdx;
+    auto windowSize = GetWindowSize();
+    LoadFrames(m_WindowBase + windowSize);
+    int endIdx = _STD min(m_WindowBase + windowSize, m_LoadedFrames);
 
     NODE_LOG("Sending window, WS=%d WB=%d END=%d", windowSize, m_WindowBase, endIdx);
 
-    for (auto it = m_Window.begin() + m_WindowBase; it != end; it++)
+    for (int id = m_WindowBase; id < endIdx; id++)
     {
-        NODE_LOG("WND: id=%d", it->data->id);
+        NODE_LOG_TRACE("WND: id=%d", id);
 
-        if (!force && it->sent)
+        auto &wnd = GetFrame(id);
+        if (!force && wnd.sent)
         {
-            NODE_LOG("WND: already sent");
+            NODE_LOG_TRACE("WND: already sent");
             continue;
         }
 
-        // mark as sent
-        it->sent = true;
-        it->acked = false;
+        SendFrame(wnd);
+    }
+}
+
+void NetSender::SendFrame(WindowPacketData &wnd)
+{
+    if (wnd.sent || wnd.retransmitted)
+    {
+        m_RetransmittedFrames++;
+        wnd.retransmitted = true;
+    }
 
-        // cancel timer
-        CancelTimer(it->timer);
+    // mark as sent
+    wnd.sent = true;
+    wnd.acked = false;
 
-        // send packet
-        SendPacket(CreateTransmissionContext(CreateOutgoingPacket(it->data), it->data));
+    // cancel timer
+    CancelTimer(&wnd);
+
+    // send packet
+    SendPacket(CreateTransmissionContext(CreateOutgoingPacket(&wnd.data), &wnd.data));
+
+    // last frame of a repair group, or of the whole input
+    auto repairGroup = m_Node->GetParams()->repairGroup;
+    auto id = wnd.data.id;
+    if (repairGroup > 0 && (id % repairGroup == repairGroup - 1 || IsLastFrame(id)))
+    {
+        SendRepairFrame(id);
     }
 }
 
+void NetSender::SendRepairFrame(int lastId)
+{
+    int firstId = lastId - lastId % m_Node->GetParams()->repairGroup;
+
+    _STD vector<const _STD string*> messages;
+    for (int id = firstId; id <= lastId; id++)
+    {
+        messages.push_back(&GetFrame(id).data.message);
+    }
+
+    // payload = <group size>:<repair block>, seqNum and ackNum refer to the first frame of the group
+    auto payload = _STD to_string(messages.size()) + ":" + ErasureEncode(messages);
+
+    NODE_LOG("Sending repair frame for messages %d..%d", firstId, lastId);
+
+    MAKE_PACKET(pkt, FRAME_TYPE_REPAIR, GetFrame(firstId).seqNum, payload.c_str(), 0, firstId);
+
+    // not part of the window, no timer and no channel errors
+    NetEntity::SendPacket(CreateTransmissionContext(pkt));
+    m_RepairFramesSent++;
+}
+
 Packet *NetSender::CreateOutgoingPacket(NodeMessageData *data)
 {
-    auto &wnd = m_Window[data->id];
-    MAKE_PACKET(pkt, FRAME_TYPE_DATA, wnd.seqNum, data->message.c_str(), -1, data->id);
+    auto &wnd = GetFrame(data->id);
+    MAKE_PACKET(pkt, FRAME_TYPE_DATA, wnd.seqNum, data->message.c_str(), 0, data->id);
     return pkt;
 }
 
@@ -158,139 +387,289 @@ void NetSender::ConstructWindow()
 {
     NODE_LOG("Constructing window");
 
-    m_Window.clear();
-    m_WindowBase = m_NextSeqNum = 0;
+    // frames are read as the window reaches them, a batch of messages each when aggregating
+    m_Source = m_Node->CreateMessageSource();
+    if (m_Node->GetParams()->maxFrameSize > 0)
+    {
+        m_Source = new AggregatingMessageSource(m_Source, m_Node->GetParams()->maxFrameSize);
+    }
 
-    for (auto &msg : m_Node->GetMessages())
+    // a repair frame covers its whole group, frames of the group before the base are kept for it.
+    // Another window of slack lets copies of acked frames leave the send pipeline before their
+    // slot is needed again
+    auto windowSize = m_Node->GetParams()->windowSize;
+    auto repairGroup = m_Node->GetParams()->repairGroup;
+    m_Window.resize(2 * windowSize + _STD max(repairGroup - 1, 0));
+    m_WindowBase = m_LoadedFrames = 0;
+    m_LoadStalled = false;
+    for (auto &wnd : m_Window)
     {
-        WindowPacketData data;
-        data.seqNum = m_NextSeqNum++;
-        data.read = false;
-        data.data = msg;
-        data.sent = data.acked = false;
-        data.timer = 0;
+        wnd.transmissions = 0;
+    }
 
-        m_Window.push_back(data);
+    NODE_LOG("Window constructed, size=%d", (int)m_Window.size());
+}
 
-        // wrap around
-        if (m_NextSeqNum == m_Node->GetParams()->windowSize)
+void NetSender::LoadFrames(int end)
+{
+    // the frame a slot held before is acked and behind the repair group of the base, it may still
+    // be in the send pipeline though
+    while (m_LoadedFrames < end)
+    {
+        auto &wnd = GetFrame(m_LoadedFrames);
+        if (wnd.transmissions > 0)
         {
-            m_NextSeqNum = 0;
+            m_LoadStalled = true;
+            break;
         }
+
+        // a late copy of the old frame may have restarted its timer
+        CancelTimer(&wnd);
+        if (!m_Source->Next(wnd.data))
+        {
+            break;
+        }
+
+        wnd.data.id = m_LoadedFrames;
+        wnd.seqNum = m_LoadedFrames % GetSeqModulus();
+        wnd.read = false;
+        wnd.sent = wnd.acked = wnd.retransmitted = false;
+        wnd.sentTime = 0;
+        wnd.firstSentTime = -1;
+        wnd.nackRetransmitted = wnd.delivered = false;
+        wnd.timer.context = &wnd.data;
+
+        m_LoadedFrames++;
     }
+}
 
-    NODE_LOG("Window constructed, size=%d", m_Window.size());
+WindowPacketData &NetSender::GetFrame(int id)
+{
+    return m_Window[id % m_Window.size()];
+}
 
-    LogWindow();
+bool NetSender::IsLastFrame(int id)
+{
+    return id == m_LoadedFrames - 1 && m_Source->AtEnd();
 }
 
-void NetSender::SendPacket(TransmissionContext *ctx, PTransmissionCallback onPostProcess, PTransmissionCallback onPreProcess)
+void NetSender::SendPacket(TransmissionContext *ctx)
 {
     auto packet = ctx->packet;
-    auto data = ctx->data;
 
-    if (data == 0)
+    if (ctx->data == 0)
     {
-        NODE_LOG("ERROR NodeMessageData null at sender");
+        NODE_LOG_ERROR("NodeMessageData null at sender");
+
+        delete packet;
+        ReleaseTransmissionContext(ctx);
         return;
     }
 
     NODE_LOG("Sending packet seqNum=%d, ackNum=%d, payload=%s", packet->getSeqNum(), packet->getAckNum(), packet->getPayload());
 
-    // start timer after processing is done
-    auto onPostProcessCallback = [this, data](TransmissionContext *ctx)
+    // channel errors are logged when processing starts, the timer starts once it is done
+    ctx->hooks = TRANSMISSION_HOOK_PRE_PROCESS | TRANSMISSION_HOOK_POST_PROCESS | TRANSMISSION_HOOK_RELEASE;
+    GetFrame(ctx->data->id).transmissions++;
+    NetEntity::SendPacket(ctx);
+}
+
+void NetSender::OnPreProcess(TransmissionContext *ctx)
+{
+    auto data = ctx->data;
+    auto wnd = &GetFrame(data->id);
+
+    if (!wnd->read)
     {
-        // start timer
-        auto wnd = &m_Window[data->id];
-        StartTimer(wnd);
+        wnd->read = true;
 
-        // log transmission
-        SysLogTransmission(ctx, wnd);
-    };
+        // syslog
+        auto record = CreateTraceRecord(SYSTRACE_EVENT_CHANNEL_ERROR);
+        record.flags = (data->flags.modification ? SYSTRACE_FLAG_MODIFICATION : 0) |
+                       (data->flags.loss ? SYSTRACE_FLAG_LOSS : 0) |
+                       (data->flags.duplication ? SYSTRACE_FLAG_DUPLICATION : 0) |
+                       (data->flags.delay ? SYSTRACE_FLAG_DELAY : 0);
+        SysLogEvent(record);
+    }
+}
 
-    auto onPreProcessCallback = [this, data](TransmissionContext *ctx)
+void NetSender::OnPostProcess(TransmissionContext *ctx)
+{
+    // start timer
+    auto wnd = &GetFrame(ctx->data->id);
+    wnd->sentTime = GetSimTime();
+    if (wnd->firstSentTime == -1)
     {
-        auto wnd = &m_Window[data->id];
+        wnd->firstSentTime = wnd->sentTime;
+    }
+    StartTimer(wnd);
 
-        if (!wnd->read)
-        {
-            wnd->read = true;
+    // log transmission
+    SysLogTransmission(ctx, wnd);
+}
 
-            // syslog
-            SysLog("At : %.2f, Node : %d, Introducing channel error with code = %d%d%d%d",
-                   GetSimTimeF(), m_NodeId, data->flags.modification, data->flags.loss, data->flags.duplication, data->flags.delay);
-        }
-    };
+void NetSender::OnDuplicateSent(TransmissionContext *ctx)
+{
+    SysLogTransmission(ctx, 0);
+}
 
-    NetEntity::SendPacket(ctx, new TransmissionCallback(onPostProcessCallback), new TransmissionCallback(onPreProcessCallback));
+void NetSender::OnRelease(TransmissionContext *ctx)
+{
+    auto &wnd = GetFrame(ctx->data->id);
+    if (--wnd.transmissions == 0 && m_LoadStalled)
+    {
+        m_LoadStalled = false;
+        SendWindow();
+    }
 }
 
 void NetSender::SysLogTransmission(TransmissionContext *ctx, WindowPacketData *wnd)
 {
-    auto packet = ctx->packet;
     auto data = ctx->data;
 
-    _STD bitset<4> parityBits(packet->getParity());
-    auto parityStr = parityBits.to_string();
-
     if (wnd == 0)
     {
-        wnd = &m_Window[data->id];
+        wnd = &GetFrame(data->id);
     }
 
     // syslog
-    SysLog("At : %.2f, Node : %d, [%s] frame with seq_num : %d and payload = %s and\ntrailer = %s, Modified = %d, Lost = %s, Duplicate = %d, Delay = %.2f",
-           GetSimTimeF(), m_NodeId, "sent", wnd->seqNum, packet->getPayload(), parityStr.c_str(),
-           ctx->modifiedBitIdx, data->flags.loss ? "YES" : "NO", ctx->nextDuplicateType++,
-           data->flags.delay ? m_Node->GetParams()->errorDelay : 0.0);
+    auto record = CreateTraceRecord(SYSTRACE_EVENT_FRAME_SENT);
+    record.seqNum = wnd->seqNum;
+    record.trailer = ctx->trailer;
+    record.trailerBits = m_FrameCheck->GetLogWidth();
+    record.modified = ctx->modifiedBitIdx;
+    record.duplicate = ctx->nextDuplicateType++;
+    record.delay = data->flags.delay ? m_Node->GetParams()->errorDelay : 0.0;
+    record.flags = data->flags.loss ? SYSTRACE_FLAG_LOSS : 0;
+    SysLogEvent(record, ctx->payload.c_str());
 }
 
 void NetSender::LogWindow()
 {
-    NODE_LOG("Window state:");
-    for (size_t i = 0; i < m_Window.size(); i++)
+    NODE_LOG_TRACE("Window state:");
+    for (int id = m_WindowBase; id < m_LoadedFrames; id++)
     {
-        bool inWindow = (i >= m_WindowBase && i < m_WindowBase + m_Node->GetParams()->windowSize);
-        NODE_LOG("[%c] Seq=%d Msg=%s",
+        bool inWindow = id < m_WindowBase + GetWindowSize();
+        NODE_LOG_TRACE("[%c] Seq=%d Msg=%s",
                  inWindow ? '*' : ' ',
-                 m_Window[i].seqNum,
-                 m_Window[i].data->message.c_str());
+                 GetFrame(id).seqNum,
+                 GetFrame(id).data.message.c_str());
     }
 }
 
 void NetSender::StartTimer(WindowPacketData *wnd)
 {
-    if (wnd->timer)
+    NODE_LOG("Starting timer at t=%ld for message %d", GetSimTime(), wnd->data.id);
+
+    // restarts the previous timer if still running
+    NetEntity::StartTimer(&wnd->timer, GetTimeout());
+}
+
+long NetSender::GetTimeout()
+{
+    auto params = m_Node->GetParams();
+    long timeout = params->adaptiveTimeout ? m_RttEstimator.GetTimeout() : (long)(params->timeoutInterval * 1000);
+
+    // backoff never shortens a fixed timeout above maxTO
+    long limit = _STD max(timeout, (long)(params->maxTimeout * 1000));
+    for (int i = 0; i < m_Backoff && timeout < limit; i++)
     {
-        // cancel previous timer
-        CancelTimer(wnd->timer);
+        timeout = _STD min(timeout * 2, limit);
     }
 
-    NODE_LOG("Starting timer at t=%ld for message %d", GetSimTime(), wnd->data->id);
+    return timeout;
+}
 
-    auto timer = new cMessage("timer");
-    timer->setKind(MSG_KIND_TIMER);
-    timer->setContextPointer(wnd->data);
+void NetSender::WithdrawFrames()
+{
+    // frames past a shrunk window are taken back, they go out again as it grows
+    int end = _STD min(m_WindowBase + m_Node->GetParams()->windowSize, m_LoadedFrames);
+    for (int id = m_WindowBase + GetWindowSize(); id < end; id++)
+    {
+        auto &withdrawn = GetFrame(id);
+        if (withdrawn.sent && !withdrawn.acked)
+        {
+            CancelTimer(&withdrawn);
+            withdrawn.sent = false;
+            withdrawn.retransmitted = true;
+        }
+    }
+}
 
-    auto delay = m_Node->GetParams()->timeoutInterval * 1000;
-    m_Node->scheduleAt(simTime() + simtime_t(delay, SIMTIME_MS), timer);
+int NetSender::GetWindowSize()
+{
+    if (!m_Node->GetParams()->adaptiveWindow)
+    {
+        return m_Node->GetParams()->windowSize;
+    }
 
-    wnd->timer = timer;
+    return (int)m_CongestionWindow;
 }
 
-void NetSender::CancelTimer(void *&timer)
+void NetSender::GrowWindow(int ackedFrames)
 {
-    if (!timer)
+    if (!m_Node->GetParams()->adaptiveWindow || ackedFrames == 0)
     {
         return;
     }
 
-    auto msg = ((omnetpp::cMessage *)timer);
-    NODE_LOG("Cancelling timer at t=%ld for node %d", GetSimTime(), ((NodeMessageData *)msg->getContextPointer())->id);
+    // additive increase, one frame per window of acked frames
+    int windowSize = GetWindowSize();
+    m_CongestionWindow += (double)ackedFrames / windowSize;
+    m_CongestionWindow = _STD min(m_CongestionWindow, (double)m_Node->GetParams()->windowSize);
+    if (GetWindowSize() != windowSize)
+    {
+        NODE_LOG("Window grows to %d", GetWindowSize());
+        m_WindowVector.record(GetWindowSize());
+    }
+}
 
-    // cancel timer
-    m_Node->cancelEvent(msg);
+void NetSender::ShrinkWindow()
+{
+    // losses of one round all stem from the same window, only the first one counts
+    if (!m_Node->GetParams()->adaptiveWindow || m_WindowBase <= m_RecoveryEnd)
+    {
+        return;
+    }
+
+    m_RecoveryEnd = m_WindowBase + GetWindowSize() - 1;
+    m_CongestionWindow = _STD max(m_CongestionWindow / 2, 1.0);
+    m_WindowDecreases++;
+
+    NODE_LOG("Window shrinks to %d", GetWindowSize());
+    m_WindowVector.record(GetWindowSize());
+}
+
+void NetSender::AddRttSample(WindowPacketData &wnd)
+{
+    // duplicate acks and acks of retransmitted frames are ambiguous (Karn)
+    if (wnd.acked || wnd.retransmitted || !wnd.sent)
+    {
+        return;
+    }
+
+    long rtt = GetSimTime() - wnd.sentTime;
+    m_RttEstimator.AddSample(rtt);
+    m_RttVector.record(rtt / 1000.0);
+
+    NODE_LOG("RTT sample %ld ms for message %d, SRTT=%.1f ms", rtt, wnd.data.id, m_RttEstimator.GetSmoothedRtt());
+
+    // a fresh ack ends the backoff
+    auto timeout = GetTimeout();
+    m_Backoff = 0;
+    if (GetTimeout() != timeout || m_Node->GetParams()->adaptiveTimeout)
+    {
+        m_TimeoutVector.record(GetTimeout() / 1000.0);
+    }
+}
+
+void NetSender::CancelTimer(WindowPacketData *wnd)
+{
+    if (!wnd->timer.IsActive())
+    {
+        return;
+    }
 
-    // bye timer
-    timer = 0;
+    NODE_LOG("Cancelling timer at t=%ld for node %d", GetSimTime(), wnd->data.id);
+    NetEntity::CancelTimer(&wnd->timer);
 }
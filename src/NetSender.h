@@ -1,8 +1,11 @@
 #pragma once
 
 #include "Common.h"
+#include "MessageSource.h"
 #include "NetEntity.h"
 #include "Node.h"
+#include "RttEstimator.h"
+#include "TimerWheel.h"
 
 #include <string>
 #include <vector>
@@ -10,35 +13,79 @@
 struct WindowPacketData
 {
     int seqNum;
-    NodeMessageData* data;
+    NodeMessageData data; // copied from the message source, id is the frame id
     
     bool read; // have we read this packet?
     bool sent; // have we sent this packet?
     bool acked; // have we received an ack for this packet?
-    void* timer;
+    bool retransmitted; // sent more than once, its ack gives no RTT sample
+    long sentTime; // in ms, last time it left processing
+    long firstSentTime; // in ms, -1 until it first leaves processing
+    bool delivered; // acked at least once, go-back-n may resend acked frames
+    bool nackRetransmitted; // resent after a NACK, further NACKs wait for its ack or timeout
+    int transmissions; // contexts still pointing at data, the slot is not reused before they are done
+    TimerHandle timer; // context is data, must not move while active
 };
 
-class NetSender : public NetEntity
+class NetSender : public virtual NetEntity
 {
 private:
+    // ring of the frames in flight, frame id in slot id % size. Sized once for WS and the open
+    // repair group, slots never move while their timers run
     _STD vector<WindowPacketData> m_Window;
+    MessageSource *m_Source;
+    int m_LoadedFrames; // frames read from the source, ids below are in the ring or acked
+    bool m_LoadStalled; // the next slot is still being transmitted, loading resumes on its release
     int m_WindowBase;
-    int m_NextSeqNum;
+    int m_RetransmittedFrames;
+    int m_RepairFramesSent;
+    RttEstimator m_RttEstimator;
+    int m_Backoff; // timeout doublings since the last fresh ack
+    omnetpp::cOutVector m_RttVector;
+    omnetpp::cOutVector m_TimeoutVector;
+    double m_CongestionWindow; // effective window in frames with adaptiveWS
+    int m_RecoveryEnd; // last id sent before the window shrank, it shrinks once per round
+    int m_WindowDecreases;
+    omnetpp::cOutVector m_WindowVector;
+    int m_SuppressedNacks;
+    double m_LatencySum; // first transmission to ack, in s
+    int m_LatencyCount;
+    omnetpp::cOutVector m_LatencyVector;
 
     void SendWindow(bool force = false);
+    void SendFrame(WindowPacketData &wnd);
+    void SendRepairFrame(int lastId);
     Packet* CreateOutgoingPacket(NodeMessageData* data);
     void ConstructWindow();
+    void LoadFrames(int end);
+    WindowPacketData& GetFrame(int id);
+    bool IsLastFrame(int id);
     void LogWindow();
     void StartTimer(WindowPacketData *wnd);
-    void CancelTimer(void *&timer);
+    void CancelTimer(WindowPacketData *wnd);
+    long GetTimeout();
+    int GetWindowSize();
+    void GrowWindow(int ackedFrames);
+    void ShrinkWindow();
+    void WithdrawFrames();
+    void AddRttSample(WindowPacketData &wnd);
 
 protected:
-    void SendPacket(TransmissionContext* ctx, PTransmissionCallback onPostProcess = 0, PTransmissionCallback onPreProcess = 0) override;
+    void ReceiveAck(int frameType, int seqNum, int ackNum);
+    void RecordStatistics();
+    virtual void OnAllAcked();
+    void SendPacket(TransmissionContext* ctx) override;
+    void OnPreProcess(TransmissionContext* ctx) override;
+    void OnPostProcess(TransmissionContext* ctx) override;
+    void OnDuplicateSent(TransmissionContext* ctx) override;
+    void OnRelease(TransmissionContext* ctx) override;
 
 public:
     NetSender(Node *node);
-    void ReceivePacket(Packet *packet, int* recvParity = 0) override;
+    ~NetSender();
+    void ReceivePacket(Packet *packet, uint32_t *recvTrailer = 0) override;
     void ReceiveTimerEvent(NodeMessageData *data) override;
     void SysLogTransmission(TransmissionContext* ctx, WindowPacketData* wnd);
     int GetType() override;
+    void Finish() override;
 };
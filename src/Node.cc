@@ -1,8 +1,12 @@
 #include "Node.h"
+#include "Coordinator.h"
+#include "MessageSource.h"
 #include "NetSender.h"
 #include "NetReceiver.h"
+#include "NetDuplex.h"
+#include "ScheduledEvent.h"
 
-#include <fstream>
+#include <string.h>
 
 Define_Module(Node);
 
@@ -13,83 +17,168 @@ Node::Node()
 
 Node::~Node()
 {
-    for (auto &msg : m_Messages)
-    {
-        delete msg;
-    }
+    delete m_NetEntity;
 }
 
 void Node::ReadParams()
 {
     NODE_LOG("Reading params");
 
+    m_Params.inputFile = par(PARAM_INPUT_FILE).stdstringValue();
+    if (m_Params.inputFile.empty())
+    {
+        m_Params.inputFile = "input" + _STD to_string(m_NodeId) + ".txt";
+    }
+
     m_Params.windowSize = par(PARAM_WINDOW_SIZE).intValue();
+    m_Params.adaptiveWindow = par(PARAM_ADAPTIVE_WINDOW).boolValue();
+
+    auto arq = par(PARAM_ARQ).stdstringValue();
+    m_Params.arqMode = arq == "sr" ? ARQ_MODE_SELECTIVE_REPEAT : ARQ_MODE_GO_BACK_N;
+    if (arq != "sr" && arq != "gbn")
+    {
+        NODE_LOG_ERROR("Unknown ARQ %s, falling back to gbn", arq.c_str());
+    }
+
+    m_Params.seqBits = par(PARAM_SEQ_BITS).intValue();
+    if (m_Params.seqBits < 0 || m_Params.seqBits > 30)
+    {
+        NODE_LOG_ERROR("Invalid seqBits %d, sizing sequence numbers for WS", m_Params.seqBits);
+        m_Params.seqBits = 0;
+    }
+
+    // go-back-n tells frames apart with one spare sequence number, selective repeat needs the
+    // window and the one before it to fit
+    if (m_Params.seqBits > 0)
+    {
+        int maxWindow = m_Params.arqMode == ARQ_MODE_SELECTIVE_REPEAT ? 1 << (m_Params.seqBits - 1) : (1 << m_Params.seqBits) - 1;
+        if (m_Params.windowSize > maxWindow)
+        {
+            NODE_LOG_ERROR("WS=%d does not fit %d bit sequence numbers, using WS=%d", m_Params.windowSize, m_Params.seqBits, maxWindow);
+            m_Params.windowSize = maxWindow;
+        }
+    }
+
+    m_Params.fastRetransmit = par(PARAM_FAST_RETRANSMIT).boolValue();
+    m_Params.ackEvery = par(PARAM_ACK_EVERY).intValue();
+    if (m_Params.ackEvery < 1)
+    {
+        NODE_LOG_ERROR("Invalid ackEvery %d, acking every frame", m_Params.ackEvery);
+        m_Params.ackEvery = 1;
+    }
+
+    m_Params.ackDelay = par(PARAM_ACK_DELAY).doubleValue();
+    m_Params.duplex = par(PARAM_DUPLEX).boolValue();
     m_Params.timeoutInterval = par(PARAM_TIMEOUT).doubleValue();
+    m_Params.adaptiveTimeout = par(PARAM_ADAPTIVE_TIMEOUT).boolValue();
+    m_Params.minTimeout = par(PARAM_MIN_TIMEOUT).doubleValue();
+    m_Params.maxTimeout = par(PARAM_MAX_TIMEOUT).doubleValue();
+    m_Params.timeoutBackoff = par(PARAM_TIMEOUT_BACKOFF).boolValue();
     m_Params.processingTime = par(PARAM_PROCESSING_TIME).doubleValue();
     m_Params.transmissionDelay = par(PARAM_TRANSMISSION_DELAY).doubleValue();
+
+    // a delay channel between the nodes (the lookahead of a parallel run) carries part of TD
+    auto channel = dynamic_cast<cDelayChannel *>(gate("port$o")->getChannel());
+    m_Params.linkDelay = channel ? channel->getDelay() : SIMTIME_ZERO;
+    if (m_Params.linkDelay > m_Params.transmissionDelay)
+    {
+        NODE_LOG_ERROR("Link delay %f exceeds TD=%f, frames arrive late", m_Params.linkDelay.dbl(), m_Params.transmissionDelay);
+        m_Params.linkDelay = m_Params.transmissionDelay;
+    }
+
     m_Params.errorDelay = par(PARAM_ERROR_DELAY).doubleValue();
     m_Params.duplicationDelay = par(PARAM_DUPLICATION_DELAY).doubleValue();
     m_Params.lossRate = par(PARAM_LOSS_RATE).doubleValue();
-
-    NODE_LOG("Read params: WS=%d, TO=%f, PT=%f, TD=%f, ED=%f, DD=%f, LP=%f",
+    m_Params.frameCheck = par(PARAM_FRAME_CHECK).stdstringValue();
+    m_Params.framing = par(PARAM_FRAMING).stdstringValue();
+    m_Params.fec = par(PARAM_FEC).boolValue();
+    m_Params.repairGroup = par(PARAM_REPAIR_GROUP).intValue();
+    m_Params.maxFrameSize = par(PARAM_MAX_FRAME_SIZE).intValue();
+    m_Params.compiledInput = par(PARAM_COMPILED_INPUT).boolValue();
+
+    NODE_LOG_INFO("Read params: WS=%d, ARQ=%s, TO=%f, PT=%f, TD=%f, ED=%f, DD=%f, LP=%f, FCS=%s, FEC=%d",
              m_Params.windowSize,
+             arq.c_str(),
              m_Params.timeoutInterval,
              m_Params.processingTime,
              m_Params.transmissionDelay,
              m_Params.errorDelay,
              m_Params.duplicationDelay,
-             m_Params.lossRate);
+             m_Params.lossRate,
+             m_Params.frameCheck.c_str(),
+             m_Params.fec);
 }
 
 bool Node::InitializeMessages()
 {
     NODE_LOG("Initializing messages");
 
-    // inputX.txt
-    char inputFilename[11];
-    sprintf(inputFilename, "input%d.txt", m_NodeId);
+    auto inputFilename = m_Params.inputFile.c_str();
+
+    if (m_Params.compiledInput && LoadWorkload())
+    {
+        return true;
+    }
 
     NODE_LOG("Reading messages from %s", inputFilename);
 
-    _STD ifstream input(inputFilename);
-    if (!input.is_open())
+    if (!m_Input.OpenRead(inputFilename))
     {
         EV << "Failed to open " << inputFilename << endl;
         return false;
     }
 
-    // read messages
-    int msgId = 0;
-
-    _STD string line;
-    while (getline(input, line))
+    // messages stay in the mapping, lines are found with memchr
+    const char *data = m_Input.GetData();
+    const char *end = data + m_Input.GetSize();
+    int lineNumber = 1;
+    int malformed = 0;
+    for (auto line = data; line < end; lineNumber++)
     {
-        if (line.empty())
+        auto eol = (const char *)memchr(line, '\n', end - line);
+        if (!eol)
         {
-            continue;
+            eol = end;
         }
 
-        _STD stringstream ss(line);
-
-        // flags: XXXX
-        char flags[5];
-        ss >> flags;
+        InputMessage msg;
+        const char *error;
+        if (WorkloadParseLine(line, eol, msg, &error))
+        {
+            m_Messages.push_back(msg);
+        }
+        else if (error)
+        {
+            NODE_LOG_ERROR("Line %d: %s", lineNumber, error);
+            malformed++;
+        }
 
-        // read message
-        auto message = line.substr((uint32_t)ss.tellg() + 1);
-        
-        // alloc data
-        auto data = new NodeMessageData;
-        data->message = message;
-        data->id = msgId++;
-        data->flags = {flags[0] == '1', flags[1] == '1', flags[2] == '1', flags[3] == '1'};
+        line = eol + 1;
+    }
 
-        m_Messages.push_back(data);
+    NODE_LOG_INFO("Read %d messages", (int)m_Messages.size());
+    if (malformed > 0)
+    {
+        NODE_LOG_ERROR("Skipped %d malformed lines in %s", malformed, inputFilename);
     }
 
-    NODE_LOG("Read %d messages", m_Messages.size());
+    return true;
+}
+
+bool Node::LoadWorkload()
+{
+    // inputX.wkl from tools/compileworkload next to inputX.txt, recompile after editing the text
+    auto &inputFilename = m_Params.inputFile;
+    auto workloadFilename = inputFilename.substr(0, inputFilename.rfind('.')) + WORKLOAD_EXTENSION;
+
+    auto error = m_Workload.Open(workloadFilename.c_str());
+    if (error)
+    {
+        NODE_LOG_INFO("Workload %s %s, reading %s", workloadFilename.c_str(), error, inputFilename.c_str());
+        return false;
+    }
 
-    input.close();
+    NODE_LOG_INFO("Loaded %d messages from %s", m_Workload.GetCount(), workloadFilename.c_str());
     return true;
 }
 
@@ -97,7 +186,11 @@ void Node::initialize()
 {
     // get node id
     m_NodeId = par("ID").intValue();
-    NODE_LOG("Initializing");
+    NodeLogSetMask(m_NodeId, par("logMask").intValue());
+    NODE_LOG_INFO("Initializing");
+
+    // parsim partitions without the coordinator open their own log
+    Coordinator::OpenLogs(getSimulation()->getSystemModule()->getSubmodule("coordinator"));
 
     // read params
     ReadParams();
@@ -115,7 +208,8 @@ void Node::handleMessage(cMessage *msg)
         NODE_LOG("Received start message, initializing net entity as sender");
 
         // init net entity
-        m_NetEntity = new NetSender(this);
+        m_NetEntity = m_Params.duplex ? (NetEntity *)new NetDuplex(this) : new NetSender(this);
+        delete msg;
         return;
 
     case MSG_KIND_PACKET:
@@ -125,26 +219,35 @@ void Node::handleMessage(cMessage *msg)
         {
             NODE_LOG("Received packet, initializing net entity as receiver");
 
-            // init net entity
-            m_NetEntity = new NetReceiver(this);
+            // init net entity, a duplex node starts sending its own input as well
+            m_NetEntity = m_Params.duplex ? (NetEntity *)new NetDuplex(this) : new NetReceiver(this);
         }
 
-        // now forward the packet to the NetEntity
+        // now forward the packet to the NetEntity, nothing holds on to it afterwards
         m_NetEntity->ReceivePacket((Packet *)msg);
+        delete msg;
         break;
 
     case MSG_KIND_TIMER:
-        // forward timer event to NetEntity
-        m_NetEntity->ReceiveTimerEvent((NodeMessageData*)msg->getContextPointer());
+        // run the expired timers of the NetEntity
+        m_NetEntity->ReceiveTimerTick();
         break;
 
     case MSG_KIND_SCHEDULED:
         // execute post-processed function
-        (*(_STD function<void()> *)msg->getContextPointer())();
+        m_NetEntity->ReceiveScheduledEvent((ScheduledEvent *)msg);
         break;
     }
 }
 
+void Node::finish()
+{
+    if (m_NetEntity)
+    {
+        m_NetEntity->Finish();
+    }
+}
+
 int Node::GetNodeId() const
 {
     return m_NodeId;
@@ -155,7 +258,14 @@ const NodeParams *Node::GetParams() const
     return &m_Params;
 }
 
-const _STD vector<NodeMessageData*> &Node::GetMessages() const
+MessageSource *Node::CreateMessageSource() const
 {
-    return m_Messages;
+    if (!m_Workload.IsOpen())
+    {
+        return new VectorMessageSource(m_Messages);
+    }
+
+    // pre-stuffed messages go out as they are, unless aggregation or repair frames need them raw
+    bool stuffed = m_Params.framing == m_Workload.GetFraming() && m_Params.maxFrameSize <= 0 && m_Params.repairGroup <= 0;
+    return new WorkloadMessageSource(m_Workload, stuffed);
 }
\ No newline at end of file
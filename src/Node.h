@@ -2,7 +2,10 @@
 #define __PROJBGDDD_NODE_H_
 
 #include "Common.h"
+#include "MappedFile.h"
 #include "NetEntity.h"
+#include "NodeLogger.h"
+#include "Workload.h"
 
 #include <omnetpp.h>
 #include <vector>
@@ -10,38 +13,50 @@
 
 using namespace omnetpp;
 
-#define NODE_LOG(msg, ...)                             \
-  {                                                    \
-    char buf[300];                                     \
-    char final_buf[320];                               \
-    sprintf(buf, msg, ##__VA_ARGS__);                  \
-    sprintf(final_buf, "[Node %d] %s", m_NodeId, buf); \
-    EV << final_buf << endl;                           \
-  }
+class MessageSource;
+
+enum ARQ_MODE
+{
+  ARQ_MODE_GO_BACK_N,
+  ARQ_MODE_SELECTIVE_REPEAT
+};
 
 struct NodeParams
 {
+  _STD string inputFile;
+  _STD string frameCheck;
+  _STD string framing;
   int windowSize;
+  int seqBits; // 0 sizes the sequence space for WS
+  bool adaptiveWindow;
+  int arqMode; // ARQ_MODE
+  bool fastRetransmit;
+  int ackEvery;
+  double ackDelay;
+  bool duplex;
   double timeoutInterval;
+  bool adaptiveTimeout;
+  double minTimeout;
+  double maxTimeout;
+  bool timeoutBackoff;
   double processingTime;
   double transmissionDelay;
+  simtime_t linkDelay; // of the port channel, spent out of transmissionDelay
   double errorDelay;
   double duplicationDelay;
   double lossRate;
+  bool fec;
+  int repairGroup;
+  int maxFrameSize;
+  bool compiledInput;
 };
 
 struct NodeMessageData
 {
   _STD string message;
   int id;
-
-  struct
-  {
-    bool modification : 1;
-    bool loss : 1;
-    bool duplication : 1;
-    bool delay : 1;
-  } flags;
+  MessageFlags flags;
+  int unframedLength; // message is already framed when >= 0, its length before framing
 };
 
 class Node : public cSimpleModule
@@ -49,22 +64,26 @@ class Node : public cSimpleModule
 private:
   int m_NodeId;
   NodeParams m_Params;
-  _STD vector<NodeMessageData*> m_Messages;
+  MappedFile m_Input;
+  _STD vector<InputMessage> m_Messages;
+  WorkloadFile m_Workload; // replaces m_Messages when a compiled input was loaded
   NetEntity *m_NetEntity;
 
   void ReadParams();
   bool InitializeMessages();
+  bool LoadWorkload();
 
 protected:
   virtual void initialize() override;
   virtual void handleMessage(cMessage *msg) override;
+  virtual void finish() override;
 
 public:
   Node();
   ~Node();
   int GetNodeId() const;
   const NodeParams* GetParams() const;
-  const _STD vector<NodeMessageData*>& GetMessages() const;
+  MessageSource* CreateMessageSource() const; // owned by the caller
 };
 
 #endif
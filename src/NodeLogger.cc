@@ -0,0 +1,71 @@
+#include "NodeLogger.h"
+#include "Common.h"
+
+#include <omnetpp.h>
+#include <stdarg.h>
+#include <vector>
+
+using namespace omnetpp;
+
+// indexed by node id, nodes without an entry log everything
+static _STD vector<unsigned> s_NodeLogMasks;
+
+void NodeLogSetMask(int nodeId, unsigned mask)
+{
+    if (nodeId < 0)
+    {
+        return;
+    }
+
+    if (nodeId >= (int)s_NodeLogMasks.size())
+    {
+        s_NodeLogMasks.resize(nodeId + 1, NODE_LOG_MASK_ALL);
+    }
+
+    s_NodeLogMasks[nodeId] = mask;
+}
+
+bool NodeLogIsEnabled(int nodeId, int level)
+{
+    if (nodeId >= 0 && nodeId < (int)s_NodeLogMasks.size() && !(s_NodeLogMasks[nodeId] & (1 << level)))
+    {
+        return false;
+    }
+
+    // EV output is thrown away in express mode anyway
+    return getEnvir()->isLoggingEnabled();
+}
+
+void NodeLogWrite(int nodeId, int level, const char *msg, ...)
+{
+    char buf[320];
+    int len = snprintf(buf, sizeof(buf), "[Node %d] ", nodeId);
+
+    va_list args;
+    va_start(args, msg);
+    vsnprintf(buf + len, sizeof(buf) - len, msg, args);
+    va_end(args);
+
+    switch (level)
+    {
+    case NODE_LOG_LEVEL_TRACE:
+        EV_TRACE << buf << endl;
+        break;
+
+    case NODE_LOG_LEVEL_DEBUG:
+        EV_DEBUG << buf << endl;
+        break;
+
+    case NODE_LOG_LEVEL_WARN:
+        EV_WARN << buf << endl;
+        break;
+
+    case NODE_LOG_LEVEL_ERROR:
+        EV_ERROR << buf << endl;
+        break;
+
+    default:
+        EV_INFO << buf << endl;
+        break;
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#define NODE_LOG_LEVEL_TRACE 0
+#define NODE_LOG_LEVEL_DEBUG 1
+#define NODE_LOG_LEVEL_INFO 2
+#define NODE_LOG_LEVEL_WARN 3
+#define NODE_LOG_LEVEL_ERROR 4
+
+#define NODE_LOG_MASK_ALL 0x1F
+
+// statements below this level are compiled out entirely, release builds only keep INFO and above
+#ifndef NODE_LOG_COMPILE_LEVEL
+#ifdef NDEBUG
+#define NODE_LOG_COMPILE_LEVEL NODE_LOG_LEVEL_INFO
+#else
+#define NODE_LOG_COMPILE_LEVEL NODE_LOG_LEVEL_TRACE
+#endif
+#endif
+
+#ifdef __GNUC__
+#define NODE_LOG_PRINTF_FORMAT __attribute__((format(printf, 3, 4)))
+#else
+#define NODE_LOG_PRINTF_FORMAT
+#endif
+
+// runtime filter, bit n of the mask enables level n for the node
+void NodeLogSetMask(int nodeId, unsigned mask);
+bool NodeLogIsEnabled(int nodeId, int level);
+
+// formats and writes to EV, only called once the statement passed both filters
+void NodeLogWrite(int nodeId, int level, const char *msg, ...) NODE_LOG_PRINTF_FORMAT;
+
+// arguments are not evaluated unless the level is enabled for the node
+#define NODE_LOG_AT(level, msg, ...)                          \
+  do                                                          \
+  {                                                           \
+    if (NodeLogIsEnabled(m_NodeId, level))                    \
+    {                                                         \
+      NodeLogWrite(m_NodeId, level, msg, ##__VA_ARGS__);      \
+    }                                                         \
+  } while (0)
+
+#define NODE_LOG_DISABLED(msg, ...) \
+  do                                \
+  {                                 \
+  } while (0)
+
+#if NODE_LOG_COMPILE_LEVEL <= NODE_LOG_LEVEL_TRACE
+#define NODE_LOG_TRACE(msg, ...) NODE_LOG_AT(NODE_LOG_LEVEL_TRACE, msg, ##__VA_ARGS__)
+#else
+#define NODE_LOG_TRACE NODE_LOG_DISABLED
+#endif
+
+#if NODE_LOG_COMPILE_LEVEL <= NODE_LOG_LEVEL_DEBUG
+#define NODE_LOG_DEBUG(msg, ...) NODE_LOG_AT(NODE_LOG_LEVEL_DEBUG, msg, ##__VA_ARGS__)
+#else
+#define NODE_LOG_DEBUG NODE_LOG_DISABLED
+#endif
+
+#if NODE_LOG_COMPILE_LEVEL <= NODE_LOG_LEVEL_INFO
+#define NODE_LOG_INFO(msg, ...) NODE_LOG_AT(NODE_LOG_LEVEL_INFO, msg, ##__VA_ARGS__)
+#else
+#define NODE_LOG_INFO NODE_LOG_DISABLED
+#endif
+
+#if NODE_LOG_COMPILE_LEVEL <= NODE_LOG_LEVEL_WARN
+#define NODE_LOG_WARN(msg, ...) NODE_LOG_AT(NODE_LOG_LEVEL_WARN, msg, ##__VA_ARGS__)
+#else
+#define NODE_LOG_WARN NODE_LOG_DISABLED
+#endif
+
+#define NODE_LOG_ERROR(msg, ...) NODE_LOG_AT(NODE_LOG_LEVEL_ERROR, msg, ##__VA_ARGS__)
+
+// general purpose protocol logging
+#define NODE_LOG NODE_LOG_DEBUG
@@ -178,8 +178,11 @@ void Packet::copy(const Packet& other)
     this->frameType = other.frameType;
     this->seqNum = other.seqNum;
     this->payload = other.payload;
-    this->parity = other.parity;
+    this->trailer = other.trailer;
     this->ackNum = other.ackNum;
+    this->fec = other.fec;
+    this->hasFec = other.hasFec;
+    this->piggybackAck = other.piggybackAck;
 }
 
 void Packet::parsimPack(omnetpp::cCommBuffer *b) const
@@ -188,8 +191,11 @@ void Packet::parsimPack(omnetpp::cCommBuffer *b) const
     doParsimPacking(b,this->frameType);
     doParsimPacking(b,this->seqNum);
     doParsimPacking(b,this->payload);
-    doParsimPacking(b,this->parity);
+    doParsimPacking(b,this->trailer);
     doParsimPacking(b,this->ackNum);
+    doParsimPacking(b,this->fec);
+    doParsimPacking(b,this->hasFec);
+    doParsimPacking(b,this->piggybackAck);
 }
 
 void Packet::parsimUnpack(omnetpp::cCommBuffer *b)
@@ -198,8 +204,11 @@ void Packet::parsimUnpack(omnetpp::cCommBuffer *b)
     doParsimUnpacking(b,this->frameType);
     doParsimUnpacking(b,this->seqNum);
     doParsimUnpacking(b,this->payload);
-    doParsimUnpacking(b,this->parity);
+    doParsimUnpacking(b,this->trailer);
     doParsimUnpacking(b,this->ackNum);
+    doParsimUnpacking(b,this->fec);
+    doParsimUnpacking(b,this->hasFec);
+    doParsimUnpacking(b,this->piggybackAck);
 }
 
 int Packet::getFrameType() const
@@ -232,14 +241,14 @@ void Packet::setPayload(const char * payload)
     this->payload = payload;
 }
 
-int Packet::getParity() const
+uint32_t Packet::getTrailer() const
 {
-    return this->parity;
+    return this->trailer;
 }
 
-void Packet::setParity(int parity)
+void Packet::setTrailer(uint32_t trailer)
 {
-    this->parity = parity;
+    this->trailer = trailer;
 }
 
 int Packet::getAckNum() const
@@ -252,6 +261,36 @@ void Packet::setAckNum(int ackNum)
     this->ackNum = ackNum;
 }
 
+uint32_t Packet::getFec() const
+{
+    return this->fec;
+}
+
+void Packet::setFec(uint32_t fec)
+{
+    this->fec = fec;
+}
+
+bool Packet::getHasFec() const
+{
+    return this->hasFec;
+}
+
+void Packet::setHasFec(bool hasFec)
+{
+    this->hasFec = hasFec;
+}
+
+int Packet::getPiggybackAck() const
+{
+    return this->piggybackAck;
+}
+
+void Packet::setPiggybackAck(int piggybackAck)
+{
+    this->piggybackAck = piggybackAck;
+}
+
 class PacketDescriptor : public omnetpp::cClassDescriptor
 {
   private:
@@ -260,8 +299,11 @@ class PacketDescriptor : public omnetpp::cClassDescriptor
         FIELD_frameType,
         FIELD_seqNum,
         FIELD_payload,
-        FIELD_parity,
+        FIELD_trailer,
         FIELD_ackNum,
+        FIELD_fec,
+        FIELD_hasFec,
+        FIELD_piggybackAck,
     };
   public:
     PacketDescriptor();
@@ -328,7 +370,7 @@ const char *PacketDescriptor::getProperty(const char *propertyName) const
 int PacketDescriptor::getFieldCount() const
 {
     omnetpp::cClassDescriptor *base = getBaseClassDescriptor();
-    return base ? 5+base->getFieldCount() : 5;
+    return base ? 8+base->getFieldCount() : 8;
 }
 
 unsigned int PacketDescriptor::getFieldTypeFlags(int field) const
@@ -343,10 +385,13 @@ unsigned int PacketDescriptor::getFieldTypeFlags(int field) const
         FD_ISEDITABLE,    // FIELD_frameType
         FD_ISEDITABLE,    // FIELD_seqNum
         FD_ISEDITABLE,    // FIELD_payload
-        FD_ISEDITABLE,    // FIELD_parity
+        FD_ISEDITABLE,    // FIELD_trailer
         FD_ISEDITABLE,    // FIELD_ackNum
+        FD_ISEDITABLE,    // FIELD_fec
+        FD_ISEDITABLE,    // FIELD_hasFec
+        FD_ISEDITABLE,    // FIELD_piggybackAck
     };
-    return (field >= 0 && field < 5) ? fieldTypeFlags[field] : 0;
+    return (field >= 0 && field < 8) ? fieldTypeFlags[field] : 0;
 }
 
 const char *PacketDescriptor::getFieldName(int field) const
@@ -361,10 +406,13 @@ const char *PacketDescriptor::getFieldName(int field) const
         "frameType",
         "seqNum",
         "payload",
-        "parity",
+        "trailer",
         "ackNum",
+        "fec",
+        "hasFec",
+        "piggybackAck",
     };
-    return (field >= 0 && field < 5) ? fieldNames[field] : nullptr;
+    return (field >= 0 && field < 8) ? fieldNames[field] : nullptr;
 }
 
 int PacketDescriptor::findField(const char *fieldName) const
@@ -374,8 +422,11 @@ int PacketDescriptor::findField(const char *fieldName) const
     if (strcmp(fieldName, "frameType") == 0) return baseIndex + 0;
     if (strcmp(fieldName, "seqNum") == 0) return baseIndex + 1;
     if (strcmp(fieldName, "payload") == 0) return baseIndex + 2;
-    if (strcmp(fieldName, "parity") == 0) return baseIndex + 3;
+    if (strcmp(fieldName, "trailer") == 0) return baseIndex + 3;
     if (strcmp(fieldName, "ackNum") == 0) return baseIndex + 4;
+    if (strcmp(fieldName, "fec") == 0) return baseIndex + 5;
+    if (strcmp(fieldName, "hasFec") == 0) return baseIndex + 6;
+    if (strcmp(fieldName, "piggybackAck") == 0) return baseIndex + 7;
     return base ? base->findField(fieldName) : -1;
 }
 
@@ -391,10 +442,13 @@ const char *PacketDescriptor::getFieldTypeString(int field) const
         "int",    // FIELD_frameType
         "int",    // FIELD_seqNum
         "string",    // FIELD_payload
-        "int",    // FIELD_parity
+        "uint32_t",    // FIELD_trailer
         "int",    // FIELD_ackNum
+        "uint32_t",    // FIELD_fec
+        "bool",    // FIELD_hasFec
+        "int",    // FIELD_piggybackAck
     };
-    return (field >= 0 && field < 5) ? fieldTypeStrings[field] : nullptr;
+    return (field >= 0 && field < 8) ? fieldTypeStrings[field] : nullptr;
 }
 
 const char **PacketDescriptor::getFieldPropertyNames(int field) const
@@ -480,8 +534,11 @@ std::string PacketDescriptor::getFieldValueAsString(omnetpp::any_ptr object, int
         case FIELD_frameType: return long2string(pp->getFrameType());
         case FIELD_seqNum: return long2string(pp->getSeqNum());
         case FIELD_payload: return oppstring2string(pp->getPayload());
-        case FIELD_parity: return long2string(pp->getParity());
+        case FIELD_trailer: return ulong2string(pp->getTrailer());
         case FIELD_ackNum: return long2string(pp->getAckNum());
+        case FIELD_fec: return ulong2string(pp->getFec());
+        case FIELD_hasFec: return bool2string(pp->getHasFec());
+        case FIELD_piggybackAck: return long2string(pp->getPiggybackAck());
         default: return "";
     }
 }
@@ -501,8 +558,11 @@ void PacketDescriptor::setFieldValueAsString(omnetpp::any_ptr object, int field,
         case FIELD_frameType: pp->setFrameType(string2long(value)); break;
         case FIELD_seqNum: pp->setSeqNum(string2long(value)); break;
         case FIELD_payload: pp->setPayload((value)); break;
-        case FIELD_parity: pp->setParity(string2long(value)); break;
+        case FIELD_trailer: pp->setTrailer(string2ulong(value)); break;
         case FIELD_ackNum: pp->setAckNum(string2long(value)); break;
+        case FIELD_fec: pp->setFec(string2ulong(value)); break;
+        case FIELD_hasFec: pp->setHasFec(string2bool(value)); break;
+        case FIELD_piggybackAck: pp->setPiggybackAck(string2long(value)); break;
         default: throw omnetpp::cRuntimeError("Cannot set field %d of class 'Packet'", field);
     }
 }
@@ -520,8 +580,11 @@ omnetpp::cValue PacketDescriptor::getFieldValue(omnetpp::any_ptr object, int fie
         case FIELD_frameType: return pp->getFrameType();
         case FIELD_seqNum: return pp->getSeqNum();
         case FIELD_payload: return pp->getPayload();
-        case FIELD_parity: return pp->getParity();
+        case FIELD_trailer: return (omnetpp::intval_t)(pp->getTrailer());
         case FIELD_ackNum: return pp->getAckNum();
+        case FIELD_fec: return (omnetpp::intval_t)(pp->getFec());
+        case FIELD_hasFec: return pp->getHasFec();
+        case FIELD_piggybackAck: return pp->getPiggybackAck();
         default: throw omnetpp::cRuntimeError("Cannot return field %d of class 'Packet' as cValue -- field index out of range?", field);
     }
 }
@@ -541,8 +604,11 @@ void PacketDescriptor::setFieldValue(omnetpp::any_ptr object, int field, int i,
         case FIELD_frameType: pp->setFrameType(omnetpp::checked_int_cast<int>(value.intValue())); break;
         case FIELD_seqNum: pp->setSeqNum(omnetpp::checked_int_cast<int>(value.intValue())); break;
         case FIELD_payload: pp->setPayload(value.stringValue()); break;
-        case FIELD_parity: pp->setParity(omnetpp::checked_int_cast<int>(value.intValue())); break;
+        case FIELD_trailer: pp->setTrailer(omnetpp::checked_int_cast<uint32_t>(value.intValue())); break;
         case FIELD_ackNum: pp->setAckNum(omnetpp::checked_int_cast<int>(value.intValue())); break;
+        case FIELD_fec: pp->setFec(omnetpp::checked_int_cast<uint32_t>(value.intValue())); break;
+        case FIELD_hasFec: pp->setHasFec(value.boolValue()); break;
+        case FIELD_piggybackAck: pp->setPiggybackAck(omnetpp::checked_int_cast<int>(value.intValue())); break;
         default: throw omnetpp::cRuntimeError("Cannot set field %d of class 'Packet'", field);
     }
 }
@@ -25,8 +25,11 @@ class Packet;
  *     int frameType;  // 0: NACK, 1: ACK, 2: Data
  *     int seqNum;
  *     string payload;
- *     int parity;
+ *     uint32_t trailer;  // frame check sequence (parity/CRC)
  *     int ackNum;     // ACK/NACK number
+ *     uint32_t fec;   // Hamming SEC-DED check bits of the payload
+ *     bool hasFec = false;  // fec is set, the sender runs FEC
+ *     int piggybackAck = -1;  // cumulative ACK number carried by a data frame, -1 if none
  * }
  * </pre>
  */
@@ -36,8 +39,11 @@ class Packet : public ::omnetpp::cPacket
     int frameType = 0;
     int seqNum = 0;
     omnetpp::opp_string payload;
-    int parity = 0;
+    uint32_t trailer = 0;
     int ackNum = 0;
+    uint32_t fec = 0;
+    bool hasFec = false;
+    int piggybackAck = -1;
 
   private:
     void copy(const Packet& other);
@@ -63,11 +69,20 @@ class Packet : public ::omnetpp::cPacket
     virtual const char * getPayload() const;
     virtual void setPayload(const char * payload);
 
-    virtual int getParity() const;
-    virtual void setParity(int parity);
+    virtual uint32_t getTrailer() const;
+    virtual void setTrailer(uint32_t trailer);
 
     virtual int getAckNum() const;
     virtual void setAckNum(int ackNum);
+
+    virtual uint32_t getFec() const;
+    virtual void setFec(uint32_t fec);
+
+    virtual bool getHasFec() const;
+    virtual void setHasFec(bool hasFec);
+
+    virtual int getPiggybackAck() const;
+    virtual void setPiggybackAck(int piggybackAck);
 };
 
 inline void doParsimPacking(omnetpp::cCommBuffer *b, const Packet& obj) {obj.parsimPack(b);}
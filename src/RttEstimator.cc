@@ -0,0 +1,38 @@
+#include "RttEstimator.h"
+
+#include <algorithm>
+#include <math.h>
+
+#define RTT_ALPHA 0.125
+#define RTT_BETA 0.25
+#define RTT_K 4
+#define RTT_GRANULARITY 1.0 // ms, one timer wheel tick
+
+RttEstimator::RttEstimator(long timeout, long minTimeout, long maxTimeout)
+{
+    m_SmoothedRtt = 0;
+    m_RttVariance = 0;
+    m_MinTimeout = minTimeout;
+    m_MaxTimeout = _STD max(minTimeout, maxTimeout);
+    m_Timeout = _STD min(_STD max(timeout, m_MinTimeout), m_MaxTimeout);
+    m_HasSample = false;
+}
+
+void RttEstimator::AddSample(long rtt)
+{
+    if (!m_HasSample)
+    {
+        m_SmoothedRtt = rtt;
+        m_RttVariance = rtt / 2.0;
+        m_HasSample = true;
+    }
+    else
+    {
+        // variance first, it uses the previous smoothed value
+        m_RttVariance = (1 - RTT_BETA) * m_RttVariance + RTT_BETA * fabs(m_SmoothedRtt - rtt);
+        m_SmoothedRtt = (1 - RTT_ALPHA) * m_SmoothedRtt + RTT_ALPHA * rtt;
+    }
+
+    auto timeout = m_SmoothedRtt + _STD max(RTT_GRANULARITY, RTT_K * m_RttVariance);
+    m_Timeout = _STD min(_STD max((long)(timeout + 0.5), m_MinTimeout), m_MaxTimeout);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Common.h"
+
+// Jacobson/Karels round trip estimator (RFC 6298), all times in ms
+class RttEstimator
+{
+private:
+    double m_SmoothedRtt;
+    double m_RttVariance;
+    long m_Timeout;
+    long m_MinTimeout;
+    long m_MaxTimeout;
+    bool m_HasSample;
+
+public:
+    // timeout is the initial value until the first sample
+    RttEstimator(long timeout, long minTimeout, long maxTimeout);
+
+    // only for frames sent once, a retransmitted frame's ack is ambiguous (Karn)
+    void AddSample(long rtt);
+
+    long GetTimeout() const { return m_Timeout; }
+    double GetSmoothedRtt() const { return m_SmoothedRtt; }
+    bool HasSample() const { return m_HasSample; }
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Common.h"
+#include "InlineFunction.h"
+
+#include <omnetpp.h>
+
+// room for the captures of the processing pipeline lambdas
+#define SCHEDULED_EVENT_CAPACITY 48
+
+// self message running a callback when it fires, NetEntity recycles it afterwards
+class ScheduledEvent : public omnetpp::cMessage
+{
+public:
+    InlineFunction<SCHEDULED_EVENT_CAPACITY> callback;
+
+    ScheduledEvent() : omnetpp::cMessage("scheduled", MSG_KIND_SCHEDULED) {}
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Common.h"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// fixed size objects carved out of slabs of SlabSize slots, released slots are reused before
+// a new slab is allocated. Slabs live as long as the allocator, so memory follows the peak
+// number of live objects
+template <typename T, _STD size_t SlabSize = 32>
+class SlabAllocator
+{
+private:
+    struct Slot
+    {
+        alignas(T) unsigned char storage[sizeof(T)];
+        Slot *next;
+        bool live;
+    };
+
+    _STD vector<_STD unique_ptr<Slot[]>> m_Slabs;
+    Slot *m_FreeList;
+    _STD size_t m_LiveCount;
+
+    void Grow()
+    {
+        auto slab = new Slot[SlabSize];
+        for (_STD size_t i = 0; i < SlabSize; i++)
+        {
+            slab[i].next = i + 1 < SlabSize ? &slab[i + 1] : m_FreeList;
+            slab[i].live = false;
+        }
+
+        m_FreeList = slab;
+        m_Slabs.emplace_back(slab);
+    }
+
+public:
+    SlabAllocator() : m_FreeList(0), m_LiveCount(0) {}
+
+    SlabAllocator(const SlabAllocator &) = delete;
+    SlabAllocator &operator=(const SlabAllocator &) = delete;
+
+    ~SlabAllocator()
+    {
+        // objects still alive at teardown
+        for (auto &slab : m_Slabs)
+        {
+            for (_STD size_t i = 0; i < SlabSize; i++)
+            {
+                if (slab[i].live)
+                {
+                    ((T *)slab[i].storage)->~T();
+                }
+            }
+        }
+    }
+
+    template <typename... Args>
+    T *Create(Args &&...args)
+    {
+        if (!m_FreeList)
+        {
+            Grow();
+        }
+
+        auto slot = m_FreeList;
+        auto obj = new (slot->storage) T(_STD forward<Args>(args)...);
+
+        m_FreeList = slot->next;
+        slot->live = true;
+        m_LiveCount++;
+
+        return obj;
+    }
+
+    void Destroy(T *obj)
+    {
+        // storage is the first member of its slot
+        auto slot = (Slot *)obj;
+        obj->~T();
+
+        slot->live = false;
+        slot->next = m_FreeList;
+        m_FreeList = slot;
+        m_LiveCount--;
+    }
+
+    _STD size_t GetLiveCount() const { return m_LiveCount; }
+    _STD size_t GetCapacity() const { return m_Slabs.size() * SlabSize; }
+};
@@ -1,23 +1,436 @@
 #include "SysLogger.h"
 #include "Common.h"
+#include "MappedFile.h"
 
 #include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#define SYSLOG_FILENAME "output.txt"
+#define SYSLOG_RING_CAPACITY (1 << 20) // must be a power of 2
+#define SYSTRACE_INITIAL_SIZE (1 << 20)
+
+// output.txt / output.trace, output-<partition>.txt / .trace for a partition of a parallel run
+static _STD string s_LogFilename = SYSLOG_FILENAME;
+static _STD string s_TraceFilename = SYSTRACE_FILENAME;
+
+// single producer (simulation thread) single consumer (flush thread) byte ring
+class SysLogRing
+{
+private:
+    char *m_Buffer;
+    _STD atomic<size_t> m_Head; // next write position, owned by producer
+    _STD atomic<size_t> m_Tail; // next read position, owned by consumer
+
+public:
+    SysLogRing() : m_Buffer(new char[SYSLOG_RING_CAPACITY]), m_Head(0), m_Tail(0) {}
+    ~SysLogRing() { delete[] m_Buffer; }
+
+    // copies as much of data as fits, returns the number of bytes taken
+    size_t Push(const char *data, size_t len)
+    {
+        auto head = m_Head.load(_STD memory_order_relaxed);
+        auto tail = m_Tail.load(_STD memory_order_acquire);
+        auto n = _STD min(len, SYSLOG_RING_CAPACITY - (head - tail));
+
+        for (size_t i = 0; i < n;)
+        {
+            auto idx = (head + i) & (SYSLOG_RING_CAPACITY - 1);
+            auto chunk = _STD min(n - i, (size_t)SYSLOG_RING_CAPACITY - idx);
+            memcpy(m_Buffer + idx, data + i, chunk);
+            i += chunk;
+        }
+
+        m_Head.store(head + n, _STD memory_order_release);
+        return n;
+    }
+
+    // returns the contiguous readable region
+    size_t Peek(const char *&data)
+    {
+        auto tail = m_Tail.load(_STD memory_order_relaxed);
+        auto head = m_Head.load(_STD memory_order_acquire);
+        auto idx = tail & (SYSLOG_RING_CAPACITY - 1);
+
+        data = m_Buffer + idx;
+        return _STD min(head - tail, (size_t)SYSLOG_RING_CAPACITY - idx);
+    }
+
+    void Consume(size_t n)
+    {
+        m_Tail.store(m_Tail.load(_STD memory_order_relaxed) + n, _STD memory_order_release);
+    }
+
+    bool Empty()
+    {
+        return m_Head.load(_STD memory_order_acquire) == m_Tail.load(_STD memory_order_acquire);
+    }
+};
+
+// appends fixed size records to a memory-mapped trace file
+class SysTraceWriter
+{
+private:
+    MappedFile m_File;
+    size_t m_Used;
+
+    bool Reserve(size_t bytes)
+    {
+        auto size = m_File.GetSize();
+        if (m_Used + bytes <= size)
+        {
+            return true;
+        }
+
+        while (m_Used + bytes > size)
+        {
+            size *= 2;
+        }
+
+        return m_File.Resize(size);
+    }
+
+public:
+    SysTraceWriter() : m_Used(0) {}
+    ~SysTraceWriter() { Close(); }
+
+    bool IsOpen() const { return m_File.IsOpen(); }
+
+    bool Open()
+    {
+        if (!m_File.OpenWrite(s_TraceFilename.c_str(), SYSTRACE_INITIAL_SIZE))
+        {
+            return false;
+        }
+
+        SysTraceHeader header = {};
+        memcpy(header.magic, SYSTRACE_MAGIC, sizeof(header.magic));
+        header.version = SYSTRACE_VERSION;
+        header.recordSize = sizeof(SysTraceRecord);
+
+        memcpy(m_File.GetData(), &header, sizeof(header));
+        m_Used = sizeof(header);
+        return true;
+    }
+
+    void Append(const SysTraceRecord &record, const char *payload, size_t payloadLength)
+    {
+        auto rec = record;
+        rec.payloadLength = (uint16_t)_STD min(payloadLength, (size_t)UINT16_MAX);
+
+        auto span = SysTraceRecordSpan(rec);
+        if (!Reserve(span))
+        {
+            return;
+        }
+
+        // padding is already zero, the file grows zero filled
+        auto dst = m_File.GetData() + m_Used;
+        memcpy(dst, &rec, sizeof(rec));
+        memcpy(dst + sizeof(rec), payload, rec.payloadLength);
+        m_Used += span;
+    }
+
+    void Close()
+    {
+        if (m_File.IsOpen())
+        {
+            // drop the unused tail
+            m_File.Resize(m_Used);
+            m_File.Close();
+        }
+
+        m_Used = 0;
+    }
+};
+
+class SysLogSink
+{
+private:
+    _STD ofstream m_File;
+    SysTraceWriter m_Trace;
+    bool m_Async;
+
+    // async state
+    SysLogRing *m_Ring;
+    _STD thread m_Thread;
+    _STD mutex m_Mutex;
+    _STD condition_variable m_Wake;
+    _STD condition_variable m_Flushed;
+    _STD atomic<bool> m_Stop;
+    _STD atomic<unsigned> m_FlushRequested;
+    unsigned m_FlushCompleted;
+
+    void Run()
+    {
+        while (true)
+        {
+            const char *data;
+            auto len = m_Ring->Peek(data);
+            if (len > 0)
+            {
+                m_File.write(data, len);
+                m_Ring->Consume(len);
+                continue;
+            }
+
+            // ring drained, serve flush requests
+            auto requested = m_FlushRequested.load();
+            if (requested != m_FlushCompleted)
+            {
+                m_File.flush();
+
+                _STD lock_guard<_STD mutex> lock(m_Mutex);
+                m_FlushCompleted = requested;
+                m_Flushed.notify_all();
+            }
+
+            if (m_Stop)
+            {
+                break;
+            }
+
+            // producer notifies without holding the lock, so cap the wait
+            _STD unique_lock<_STD mutex> lock(m_Mutex);
+            m_Wake.wait_for(lock, _STD chrono::milliseconds(10), [this]()
+                            { return m_Stop || !m_Ring->Empty() || m_FlushRequested.load() != m_FlushCompleted; });
+        }
+
+        m_File.flush();
+    }
+
+public:
+    SysLogSink() : m_Async(false), m_Ring(0), m_Stop(false), m_FlushRequested(0), m_FlushCompleted(0) {}
+    ~SysLogSink() { Close(); }
+
+    bool IsOpen() const { return m_File.is_open() || m_Trace.IsOpen(); }
+    bool IsBinary() const { return m_Trace.IsOpen(); }
+
+    void Open(bool async, bool binary)
+    {
+        Close();
+
+        if (binary && m_Trace.Open())
+        {
+            // records are plain memcpys into the mapping, no flush thread needed
+            return;
+        }
+
+        m_File.open(s_LogFilename, _STD ios::app);
+        m_Async = async;
+
+        if (m_Async)
+        {
+            m_Ring = new SysLogRing;
+            m_Stop = false;
+            m_FlushRequested = m_FlushCompleted = 0;
+            m_Thread = _STD thread(&SysLogSink::Run, this);
+        }
+    }
+
+    void Append(const SysTraceRecord &record, const char *payload, size_t payloadLength)
+    {
+        m_Trace.Append(record, payload, payloadLength);
+    }
+
+    void Write(const char *data, size_t len)
+    {
+        if (!m_Async)
+        {
+            m_File.write(data, len);
+            return;
+        }
+
+        // ring is bounded, wait for the flush thread to make room
+        while (len > 0)
+        {
+            auto n = m_Ring->Push(data, len);
+            data += n;
+            len -= n;
+
+            if (len > 0)
+            {
+                m_Wake.notify_one();
+                _STD this_thread::yield();
+            }
+        }
+    }
+
+    void Flush()
+    {
+        if (IsBinary())
+        {
+            // the mapping is written back by the OS
+            return;
+        }
+
+        if (!m_Async)
+        {
+            m_File.flush();
+            return;
+        }
+
+        auto ticket = ++m_FlushRequested;
+        m_Wake.notify_one();
+
+        _STD unique_lock<_STD mutex> lock(m_Mutex);
+        m_Flushed.wait(lock, [this, ticket]()
+                       { return (int)(m_FlushCompleted - ticket) >= 0; });
+    }
+
+    void Close()
+    {
+        if (m_Async)
+        {
+            m_Stop = true;
+            m_Wake.notify_one();
+            m_Thread.join();
+
+            delete m_Ring;
+            m_Ring = 0;
+            m_Async = false;
+        }
+
+        if (m_File.is_open())
+        {
+            m_File.close();
+        }
+
+        m_Trace.Close();
+    }
+};
+
+static SysLogSink s_Sink;
 
 void SysDeleteLogs()
 {
-    _STD remove("output.txt");
+    s_Sink.Close();
+    _STD remove(s_LogFilename.c_str());
+    _STD remove(s_TraceFilename.c_str());
+}
+
+void SysLogSetPartition(int partition)
+{
+    s_Sink.Close();
+
+    if (partition < 0)
+    {
+        s_LogFilename = SYSLOG_FILENAME;
+        s_TraceFilename = SYSTRACE_FILENAME;
+        return;
+    }
+
+    s_LogFilename = "output-" + _STD to_string(partition) + ".txt";
+    s_TraceFilename = "output-" + _STD to_string(partition) + ".trace";
 }
 
 void SysLog(const char *msg, ...)
 {
     char buf[300];
-    va_list args;
+    va_list args, argsCopy;
     va_start(args, msg);
-    vsprintf(buf, msg, args);
+    va_copy(argsCopy, args);
+    int len = vsnprintf(buf, sizeof(buf), msg, args);
     va_end(args);
 
-    _STD ofstream log("output.txt", _STD ios::app);
-    log << buf << '\n' << _STD endl;
-    log.close();
-}
\ No newline at end of file
+    if (!s_Sink.IsOpen())
+    {
+        // nobody configured the sink, behave like the synchronous logger
+        s_Sink.Open(false, false);
+    }
+
+    if (s_Sink.IsBinary())
+    {
+        SysTraceRecord record = {};
+        record.type = SYSTRACE_EVENT_TEXT;
+
+        if (len >= (int)sizeof(buf))
+        {
+            _STD string longBuf(len + 1, '\0');
+            vsnprintf(&longBuf[0], len + 1, msg, argsCopy);
+            s_Sink.Append(record, longBuf.c_str(), len);
+        }
+        else
+        {
+            s_Sink.Append(record, buf, _STD max(len, 0));
+        }
+
+        va_end(argsCopy);
+        return;
+    }
+
+    if (len >= (int)sizeof(buf))
+    {
+        // long payloads, format again into a big enough buffer
+        _STD string longBuf(len + 1, '\0');
+        vsnprintf(&longBuf[0], len + 1, msg, argsCopy);
+        s_Sink.Write(longBuf.c_str(), len);
+    }
+    else if (len > 0)
+    {
+        s_Sink.Write(buf, len);
+    }
+
+    va_end(argsCopy);
+
+    // every entry is followed by an empty line
+    s_Sink.Write("\n\n", 2);
+}
+
+void SysLogEvent(const SysTraceRecord &record, const char *payload)
+{
+    if (!s_Sink.IsOpen())
+    {
+        s_Sink.Open(false, false);
+    }
+
+    auto payloadLength = payload ? strlen(payload) : 0;
+    if (s_Sink.IsBinary())
+    {
+        s_Sink.Append(record, payload, payloadLength);
+        return;
+    }
+
+    // text mode, render it the same way the offline converter does
+    char buf[300];
+    int len = SysTraceFormat(record, payload, payloadLength, buf, sizeof(buf));
+    if (len >= (int)sizeof(buf))
+    {
+        _STD string longBuf(len + 1, '\0');
+        SysTraceFormat(record, payload, payloadLength, &longBuf[0], len + 1);
+        s_Sink.Write(longBuf.c_str(), len);
+    }
+    else if (len > 0)
+    {
+        s_Sink.Write(buf, len);
+    }
+
+    s_Sink.Write("\n\n", 2);
+}
+
+void SysLogOpen(bool async, bool binary)
+{
+    s_Sink.Open(async, binary);
+}
+
+bool SysLogIsOpen()
+{
+    return s_Sink.IsOpen();
+}
+
+void SysLogFlush()
+{
+    s_Sink.Flush();
+}
+
+void SysLogClose()
+{
+    s_Sink.Close();
+}
@@ -1,4 +1,25 @@
 #pragma once
 
+#include "SysTrace.h"
+
 void SysDeleteLogs();
-void SysLog(const char *msg, ...);
\ No newline at end of file
+void SysLog(const char *msg, ...);
+
+// protocol event, rendered into output.txt or appended to the binary trace
+void SysLogEvent(const SysTraceRecord &record, const char *payload = 0);
+
+// opens the persistent output.txt sink, async hands lines over to a background flush thread,
+// binary records events into a memory-mapped output.trace instead (see tools/TraceToText)
+void SysLogOpen(bool async, bool binary = false);
+
+// partitions of a parallel run log to output-<partition>.txt (.trace) instead, -1 for the plain
+// names. Takes effect for files opened or deleted afterwards
+void SysLogSetPartition(int partition);
+
+bool SysLogIsOpen();
+
+// blocks until every line logged so far has reached the file
+void SysLogFlush();
+
+// flushes and closes the sink, stopping the flush thread if any
+void SysLogClose();
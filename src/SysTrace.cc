@@ -0,0 +1,63 @@
+#include "SysTrace.h"
+#include "Common.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <bitset>
+#include <string>
+
+size_t SysTraceRecordSpan(const SysTraceRecord &record)
+{
+    auto payloadRecords = (record.payloadLength + sizeof(SysTraceRecord) - 1) / sizeof(SysTraceRecord);
+    return (1 + payloadRecords) * sizeof(SysTraceRecord);
+}
+
+int SysTraceFormat(const SysTraceRecord &record, const char *payload, size_t payloadLength, char *buf, size_t bufSize)
+{
+    // same float rounding as NetEntity::GetSimTimeF
+    auto time = record.time / 1000.0f;
+    auto payloadStr = payload ? _STD string(payload, payloadLength) : _STD string();
+
+    switch (record.type)
+    {
+    case SYSTRACE_EVENT_TEXT:
+        return snprintf(buf, bufSize, "%s", payloadStr.c_str());
+
+    case SYSTRACE_EVENT_CHANNEL_ERROR:
+        return snprintf(buf, bufSize, "At : %.2f, Node : %d, Introducing channel error with code = %d%d%d%d",
+                        time, record.node,
+                        (record.flags & SYSTRACE_FLAG_MODIFICATION) != 0,
+                        (record.flags & SYSTRACE_FLAG_LOSS) != 0,
+                        (record.flags & SYSTRACE_FLAG_DUPLICATION) != 0,
+                        (record.flags & SYSTRACE_FLAG_DELAY) != 0);
+
+    case SYSTRACE_EVENT_FRAME_SENT:
+    {
+        auto trailerBits = _STD bitset<32>(record.trailer).to_string();
+        auto trailerStr = trailerBits.substr(32 - (record.trailerBits ? _STD min((int)record.trailerBits, 32) : 4));
+        return snprintf(buf, bufSize, "At : %.2f, Node : %d, [%s] frame with seq_num : %d and payload = %s and\ntrailer = %s, Modified = %d, Lost = %s, Duplicate = %d, Delay = %.2f",
+                        time, record.node, "sent", record.seqNum, payloadStr.c_str(), trailerStr.c_str(),
+                        record.modified, (record.flags & SYSTRACE_FLAG_LOSS) ? "YES" : "NO", record.duplicate,
+                        record.delay);
+    }
+
+    case SYSTRACE_EVENT_NACK_RECEIVED:
+        return snprintf(buf, bufSize, "At : %.2f, Node : %d, [%s] NACK for seq_number : %d",
+                        time, record.node, "received", record.seqNum);
+
+    case SYSTRACE_EVENT_TIMEOUT:
+        return snprintf(buf, bufSize, "Time out event at time : %.2f, Node : %d, for frame with seq_num = %d",
+                        time, record.node, record.seqNum);
+
+    case SYSTRACE_EVENT_FRAME_RECEIVED:
+        return snprintf(buf, bufSize, "At : %.2f Node : %d Received packet with seqNum : %d, payload = %s",
+                        time, record.node, record.seqNum, payloadStr.c_str());
+
+    case SYSTRACE_EVENT_ACK_SENT:
+        return snprintf(buf, bufSize, "At time : %.2f Node : %d Sending %s with number : %d, loss : %s",
+                        time, record.node, (record.flags & SYSTRACE_FLAG_NACK) ? "NACK" : "ACK", record.seqNum,
+                        (record.flags & SYSTRACE_FLAG_LOST) ? "YES" : "NO");
+    }
+
+    return snprintf(buf, bufSize, "Unknown trace event %d", record.type);
+}
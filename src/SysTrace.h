@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SYSTRACE_FILENAME "output.trace"
+#define SYSTRACE_MAGIC "SYSTRACE"
+#define SYSTRACE_VERSION 2
+
+enum SYSTRACE_EVENT
+{
+    SYSTRACE_EVENT_END = 0, // zero filled tail of an unfinished trace
+    SYSTRACE_EVENT_TEXT,    // free form SysLog line, text in payload
+    SYSTRACE_EVENT_CHANNEL_ERROR,
+    SYSTRACE_EVENT_FRAME_SENT,
+    SYSTRACE_EVENT_NACK_RECEIVED,
+    SYSTRACE_EVENT_TIMEOUT,
+    SYSTRACE_EVENT_FRAME_RECEIVED,
+    SYSTRACE_EVENT_ACK_SENT
+};
+
+// low 4 bits hold the error code (modification, loss, duplication, delay)
+#define SYSTRACE_FLAG_MODIFICATION (1 << 3)
+#define SYSTRACE_FLAG_LOSS (1 << 2)
+#define SYSTRACE_FLAG_DUPLICATION (1 << 1)
+#define SYSTRACE_FLAG_DELAY (1 << 0)
+#define SYSTRACE_FLAG_LOST (1 << 4) // ACK/NACK lost
+#define SYSTRACE_FLAG_NACK (1 << 5) // NACK rather than ACK
+
+struct SysTraceHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+};
+
+// fixed size record, payload bytes (if any) follow padded to a multiple of the record size
+struct SysTraceRecord
+{
+    int64_t time;   // ms
+    double delay;   // s
+    int32_t node;
+    int32_t seqNum;
+    uint32_t trailer;
+    int32_t modified; // modified bit index, -1 if none
+    int16_t duplicate;
+    uint16_t payloadLength;
+    uint8_t type;
+    uint8_t flags;
+    uint8_t trailerBits; // trailer bits rendered in text, 0 means 4
+    uint8_t reserved;
+};
+
+static_assert(sizeof(SysTraceRecord) == 40, "SysTraceRecord layout changed");
+
+// bytes a record occupies in the trace including its payload
+size_t SysTraceRecordSpan(const SysTraceRecord &record);
+
+// renders a record exactly like the text logger would, returns length (excluding the trailing empty line)
+int SysTraceFormat(const SysTraceRecord &record, const char *payload, size_t payloadLength, char *buf, size_t bufSize);
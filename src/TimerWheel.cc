@@ -0,0 +1,104 @@
+#include "TimerWheel.h"
+
+TimerWheel::TimerWheel(size_t slots, long tick) : m_Slots(slots), m_Tick(tick), m_Cursor(0)
+{
+    // empty circular lists
+    for (auto &head : m_Slots)
+    {
+        head.prev = head.next = &head;
+    }
+}
+
+TimerHandle &TimerWheel::SlotOf(long tick)
+{
+    return m_Slots[tick % (long)m_Slots.size()];
+}
+
+void TimerWheel::Start(TimerHandle *timer, long expiry)
+{
+    Cancel(timer);
+
+    // append, timers due at the same time fire in start order
+    auto &head = SlotOf(expiry / m_Tick);
+    timer->expiry = expiry;
+    timer->prev = head.prev;
+    timer->next = &head;
+    head.prev->next = timer;
+    head.prev = timer;
+}
+
+void TimerWheel::Cancel(TimerHandle *timer)
+{
+    if (!timer->IsActive())
+    {
+        return;
+    }
+
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+    timer->prev = timer->next = 0;
+}
+
+TimerHandle *TimerWheel::PopExpired(long now)
+{
+    auto nowTick = now / m_Tick;
+
+    // a full revolution visits every slot
+    if (nowTick - m_Cursor >= (long)m_Slots.size())
+    {
+        m_Cursor = nowTick - (long)m_Slots.size() + 1;
+    }
+
+    for (;; m_Cursor++)
+    {
+        auto &head = SlotOf(m_Cursor);
+        for (auto timer = head.next; timer != &head; timer = timer->next)
+        {
+            if (timer->expiry <= now)
+            {
+                Cancel(timer);
+                return timer;
+            }
+        }
+
+        // stay on the current tick, timers may still be started for it
+        if (m_Cursor == nowTick)
+        {
+            return 0;
+        }
+    }
+}
+
+long TimerWheel::GetNextExpiry()
+{
+    long next = -1;
+    auto slots = (long)m_Slots.size();
+
+    // walk one revolution in tick order, the first slot holding a timer of its own tick has the earliest
+    for (long tick = m_Cursor; tick < m_Cursor + slots; tick++)
+    {
+        long current = -1;
+
+        auto &head = SlotOf(tick);
+        for (auto timer = head.next; timer != &head; timer = timer->next)
+        {
+            if (timer->expiry / m_Tick == tick && (current == -1 || timer->expiry < current))
+            {
+                current = timer->expiry;
+            }
+
+            if (next == -1 || timer->expiry < next)
+            {
+                next = timer->expiry;
+            }
+        }
+
+        if (current != -1)
+        {
+            return current;
+        }
+    }
+
+    // everything is further out than a revolution
+    return next;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Common.h"
+
+#include <stddef.h>
+#include <vector>
+
+// intrusive timer entry, owned by whoever arms it and reused across restarts
+struct TimerHandle
+{
+    TimerHandle *prev;
+    TimerHandle *next;
+    long expiry; // in ms
+    void *context;
+
+    TimerHandle() : prev(0), next(0), expiry(0), context(0) {}
+    bool IsActive() const { return prev != 0; }
+};
+
+// hashed timing wheel, one slot per tick. Timers more than a revolution away share a slot with
+// nearer ones and are skipped until their tick comes round, start and cancel are O(1)
+class TimerWheel
+{
+private:
+    _STD vector<TimerHandle> m_Slots; // list heads, never resized
+    long m_Tick; // ms per slot
+    long m_Cursor; // first tick that may still hold due timers
+
+    TimerHandle &SlotOf(long tick);
+
+public:
+    TimerWheel(size_t slots = 1024, long tick = 1);
+
+    // arms the timer, restarting it if already active
+    void Start(TimerHandle *timer, long expiry);
+    void Cancel(TimerHandle *timer);
+
+    // unlinks and returns the next timer due at now, in expiry then start order, null if none
+    TimerHandle *PopExpired(long now);
+
+    // earliest expiry of all active timers, -1 if none
+    long GetNextExpiry();
+};
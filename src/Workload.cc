@@ -0,0 +1,174 @@
+#include "Workload.h"
+
+#include <string.h>
+
+bool WorkloadParseLine(const char *line, const char *end, InputMessage &msg, const char **error)
+{
+    *error = 0;
+
+    if (end > line && end[-1] == '\r')
+    {
+        end--;
+    }
+
+    if (line == end)
+    {
+        return false;
+    }
+
+    // XXXX <message>, one bit per channel error
+    if (end - line < 5 || line[4] != ' ')
+    {
+        *error = "expected 4 flag bits and a space before the message";
+        return false;
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (line[i] != '0' && line[i] != '1')
+        {
+            *error = "invalid flag bit";
+            return false;
+        }
+    }
+
+    msg.message = _STD string_view(line + 5, end - line - 5);
+    msg.flags = {line[0] == '1', line[1] == '1', line[2] == '1', line[3] == '1'};
+    return true;
+}
+
+uint8_t WorkloadPackFlags(MessageFlags flags)
+{
+    return flags.modification << 3 | flags.loss << 2 | flags.duplication << 1 | flags.delay;
+}
+
+MessageFlags WorkloadUnpackFlags(uint8_t bits)
+{
+    return {(bits & 8) != 0, (bits & 4) != 0, (bits & 2) != 0, (bits & 1) != 0};
+}
+
+size_t WorkloadTableSize(uint32_t count, bool stuffed)
+{
+    return sizeof(WorkloadHeader) + (count + 1) * sizeof(uint32_t) * (stuffed ? 2 : 1) + (count + 1) / 2;
+}
+
+WorkloadFile::WorkloadFile()
+{
+    memset(&m_Header, 0, sizeof(m_Header));
+    m_Offsets = m_StuffedOffsets = 0;
+    m_Flags = 0;
+}
+
+const char *WorkloadFile::Open(const char *path)
+{
+    Close();
+
+    if (!m_File.OpenRead(path))
+    {
+        return "cannot be opened";
+    }
+
+    auto error = Validate();
+    if (error)
+    {
+        Close();
+    }
+
+    return error;
+}
+
+const char *WorkloadFile::Validate()
+{
+    auto data = m_File.GetData();
+    auto size = m_File.GetSize();
+
+    if (size < sizeof(m_Header))
+    {
+        return "is not a workload file";
+    }
+
+    memcpy(&m_Header, data, sizeof(m_Header));
+    if (memcmp(m_Header.magic, WORKLOAD_MAGIC, sizeof(m_Header.magic)) != 0)
+    {
+        return "is not a workload file";
+    }
+
+    if (m_Header.version != WORKLOAD_VERSION)
+    {
+        return "has an unsupported workload version";
+    }
+
+    m_Header.framing[sizeof(m_Header.framing) - 1] = 0;
+    bool stuffed = m_Header.framing[0] != 0;
+    if (m_Header.count >= INT32_MAX / 2 || WorkloadTableSize(m_Header.count, stuffed) > size)
+    {
+        return "is truncated";
+    }
+
+    // the mapping is page aligned and the header keeps the tables 4 byte aligned
+    m_Offsets = (const uint32_t *)(data + sizeof(m_Header));
+    m_StuffedOffsets = stuffed ? m_Offsets + m_Header.count + 1 : 0;
+    m_Flags = (const uint8_t *)(m_Offsets + (m_Header.count + 1) * (stuffed ? 2 : 1));
+
+    // offsets are checked once so reading a message needs no bounds checks
+    for (auto offsets : {m_Offsets, m_StuffedOffsets})
+    {
+        if (!offsets)
+        {
+            continue;
+        }
+
+        if (offsets[0] < WorkloadTableSize(m_Header.count, stuffed) || offsets[m_Header.count] > size)
+        {
+            return "has offsets outside the file";
+        }
+
+        for (uint32_t i = 0; i < m_Header.count; i++)
+        {
+            if (offsets[i] > offsets[i + 1])
+            {
+                return "has offsets out of order";
+            }
+        }
+    }
+
+    return 0;
+}
+
+void WorkloadFile::Close()
+{
+    m_File.Close();
+    memset(&m_Header, 0, sizeof(m_Header));
+    m_Offsets = m_StuffedOffsets = 0;
+    m_Flags = 0;
+}
+
+bool WorkloadFile::IsOpen() const
+{
+    return m_Offsets != 0;
+}
+
+int WorkloadFile::GetCount() const
+{
+    return (int)m_Header.count;
+}
+
+const char *WorkloadFile::GetFraming() const
+{
+    return m_Header.framing;
+}
+
+_STD string_view WorkloadFile::GetMessage(int i) const
+{
+    return _STD string_view(m_File.GetData() + m_Offsets[i], m_Offsets[i + 1] - m_Offsets[i]);
+}
+
+_STD string_view WorkloadFile::GetStuffedMessage(int i) const
+{
+    return _STD string_view(m_File.GetData() + m_StuffedOffsets[i], m_StuffedOffsets[i + 1] - m_StuffedOffsets[i]);
+}
+
+MessageFlags WorkloadFile::GetFlags(int i) const
+{
+    return WorkloadUnpackFlags(m_Flags[i / 2] >> (i % 2 * 4) & 0xF);
+}
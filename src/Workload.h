@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Common.h"
+#include "MappedFile.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string_view>
+
+#define WORKLOAD_EXTENSION ".wkl"
+#define WORKLOAD_MAGIC "WORKLOAD"
+#define WORKLOAD_VERSION 1
+
+// channel errors of a message, the XXXX prefix of its input line
+struct MessageFlags
+{
+    bool modification : 1;
+    bool loss : 1;
+    bool duplication : 1;
+    bool delay : 1;
+};
+
+// input line as read, the message points into the mapped input file
+struct InputMessage
+{
+    _STD string_view message;
+    MessageFlags flags;
+};
+
+// parses an "XXXX <message>" line without its newline. Returns false for a line without a
+// message, error is then set if the line is malformed and null if it is just empty
+bool WorkloadParseLine(const char *line, const char *end, InputMessage &msg, const char **error);
+
+// flags as a nibble, modification in bit 3 down to delay in bit 0 like the input line
+uint8_t WorkloadPackFlags(MessageFlags flags);
+MessageFlags WorkloadUnpackFlags(uint8_t bits);
+
+// followed by count + 1 message offsets, count + 1 stuffed message offsets if framing is set and
+// the flags two messages per byte (even ids in the low nibble), then the messages themselves.
+// Offsets are from the start of the file, message i spans offsets[i] .. offsets[i + 1]
+struct WorkloadHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    char framing[16]; // framing the stuffed messages were encoded with, empty if there are none
+};
+
+static_assert(sizeof(WorkloadHeader) == 32, "WorkloadHeader layout changed");
+
+// bytes before the first message of a workload
+size_t WorkloadTableSize(uint32_t count, bool stuffed);
+
+// compiled inputX.txt, mapped read-only and read in place
+class WorkloadFile
+{
+private:
+    MappedFile m_File;
+    WorkloadHeader m_Header;
+    const uint32_t *m_Offsets;
+    const uint32_t *m_StuffedOffsets; // null if not pre-stuffed
+    const uint8_t *m_Flags;
+
+    const char *Validate();
+
+public:
+    WorkloadFile();
+
+    // maps and checks a workload, returns null on success or why it cannot be used
+    const char *Open(const char *path);
+    void Close();
+
+    bool IsOpen() const;
+    int GetCount() const;
+    const char *GetFraming() const; // empty if the messages are not pre-stuffed
+    _STD string_view GetMessage(int i) const;
+    _STD string_view GetStuffedMessage(int i) const;
+    MessageFlags GetFlags(int i) const;
+};
@@ -0,0 +1,91 @@
+// Renders a binary output.trace into the output.txt text format.
+// usage: tracetotext [output.trace] [output.txt]
+
+#include "MappedFile.h"
+#include "SysTrace.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+int main(int argc, char **argv)
+{
+    auto inputFilename = argc > 1 ? argv[1] : SYSTRACE_FILENAME;
+    auto outputFilename = argc > 2 ? argv[2] : "output.txt";
+
+    MappedFile trace;
+    if (!trace.OpenRead(inputFilename))
+    {
+        fprintf(stderr, "Failed to open %s\n", inputFilename);
+        return 1;
+    }
+
+    auto data = trace.GetData();
+    auto size = trace.GetSize();
+
+    SysTraceHeader header;
+    if (size < sizeof(header) || (memcpy(&header, data, sizeof(header)), memcmp(header.magic, SYSTRACE_MAGIC, sizeof(header.magic)) != 0))
+    {
+        fprintf(stderr, "%s is not a trace file\n", inputFilename);
+        return 1;
+    }
+
+    if (header.version != SYSTRACE_VERSION || header.recordSize != sizeof(SysTraceRecord))
+    {
+        fprintf(stderr, "%s has unsupported trace version %u\n", inputFilename, header.version);
+        return 1;
+    }
+
+    auto output = fopen(outputFilename, "w");
+    if (!output)
+    {
+        fprintf(stderr, "Failed to open %s\n", outputFilename);
+        return 1;
+    }
+
+    char buf[300];
+    std::string longBuf;
+    size_t count = 0;
+
+    for (size_t offset = sizeof(header); offset + sizeof(SysTraceRecord) <= size;)
+    {
+        SysTraceRecord record;
+        memcpy(&record, data + offset, sizeof(record));
+
+        // zero tail of a trace whose writer did not shut down cleanly
+        if (record.type == SYSTRACE_EVENT_END)
+        {
+            break;
+        }
+
+        auto span = SysTraceRecordSpan(record);
+        if (offset + span > size)
+        {
+            fprintf(stderr, "Truncated record at offset %zu\n", offset);
+            break;
+        }
+
+        auto payload = data + offset + sizeof(record);
+        int len = SysTraceFormat(record, payload, record.payloadLength, buf, sizeof(buf));
+        if (len >= (int)sizeof(buf))
+        {
+            longBuf.assign(len + 1, '\0');
+            SysTraceFormat(record, payload, record.payloadLength, &longBuf[0], len + 1);
+            fwrite(longBuf.c_str(), 1, len, output);
+        }
+        else if (len > 0)
+        {
+            fwrite(buf, 1, len, output);
+        }
+
+        // every entry is followed by an empty line
+        fputs("\n\n", output);
+
+        offset += span;
+        count++;
+    }
+
+    fclose(output);
+    printf("Converted %zu records from %s to %s\n", count, inputFilename, outputFilename);
+    return 0;
+}
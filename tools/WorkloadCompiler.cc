@@ -0,0 +1,161 @@
+// Compiles an inputX.txt into the binary workload a node loads with compiledInput.
+// usage: compileworkload [-f framing] input0.txt [input0.wkl]
+// -f also stores every message stuffed with that framing ("flag", "cobs" or "length")
+
+#include "Framing.h"
+#include "MappedFile.h"
+#include "Workload.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    const char *framingName = 0;
+    int arg = 1;
+    if (arg + 1 < argc && strcmp(argv[arg], "-f") == 0)
+    {
+        framingName = argv[arg + 1];
+        arg += 2;
+    }
+
+    if (arg >= argc)
+    {
+        fprintf(stderr, "usage: compileworkload [-f framing] input0.txt [input0%s]\n", WORKLOAD_EXTENSION);
+        return 1;
+    }
+
+    auto inputFilename = argv[arg];
+    std::string outputFilename;
+    if (arg + 1 < argc)
+    {
+        outputFilename = argv[arg + 1];
+    }
+    else
+    {
+        outputFilename = inputFilename;
+        auto dot = outputFilename.rfind('.');
+        outputFilename = outputFilename.substr(0, dot == std::string::npos ? outputFilename.size() : dot) + WORKLOAD_EXTENSION;
+    }
+
+    Framing *framing = 0;
+    if (framingName && (!(framing = Framing::Create(framingName)) || strlen(framingName) >= sizeof(WorkloadHeader::framing)))
+    {
+        fprintf(stderr, "Unknown framing %s\n", framingName);
+        return 1;
+    }
+
+    MappedFile input;
+    if (!input.OpenRead(inputFilename))
+    {
+        fprintf(stderr, "Failed to open %s\n", inputFilename);
+        return 1;
+    }
+
+    // same rules as the node applies to the text input, malformed lines are skipped
+    std::vector<InputMessage> messages;
+    const char *data = input.GetData();
+    const char *end = data + input.GetSize();
+    int lineNumber = 1;
+    for (auto line = data; line < end; lineNumber++)
+    {
+        auto eol = (const char *)memchr(line, '\n', end - line);
+        if (!eol)
+        {
+            eol = end;
+        }
+
+        InputMessage msg;
+        const char *error;
+        if (WorkloadParseLine(line, eol, msg, &error))
+        {
+            messages.push_back(msg);
+        }
+        else if (error)
+        {
+            fprintf(stderr, "%s:%d: %s, skipped\n", inputFilename, lineNumber, error);
+        }
+
+        line = eol + 1;
+    }
+
+    uint32_t count = (uint32_t)messages.size();
+    size_t tableSize = WorkloadTableSize(count, framing != 0);
+
+    size_t messageBytes = 0;
+    for (auto &msg : messages)
+    {
+        messageBytes += msg.message.size();
+    }
+
+    std::string stuffed;
+    std::vector<uint32_t> stuffedOffsets;
+    if (framing)
+    {
+        for (auto &msg : messages)
+        {
+            stuffedOffsets.push_back((uint32_t)(tableSize + messageBytes + stuffed.size()));
+            size_t start = stuffed.size();
+            stuffed.resize(start + framing->MaxEncodedSize(msg.message.size()));
+            stuffed.resize(start + framing->Encode(msg.message.data(), msg.message.size(), &stuffed[start]));
+        }
+
+        stuffedOffsets.push_back((uint32_t)(tableSize + messageBytes + stuffed.size()));
+    }
+
+    size_t size = tableSize + messageBytes + stuffed.size();
+    if (size > UINT32_MAX)
+    {
+        fprintf(stderr, "%s is too large for a workload\n", inputFilename);
+        return 1;
+    }
+
+    MappedFile output;
+    if (!output.OpenWrite(outputFilename.c_str(), size))
+    {
+        fprintf(stderr, "Failed to open %s\n", outputFilename.c_str());
+        return 1;
+    }
+
+    auto out = output.GetData();
+
+    WorkloadHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, WORKLOAD_MAGIC, sizeof(header.magic));
+    header.version = WORKLOAD_VERSION;
+    header.count = count;
+    if (framing)
+    {
+        strcpy(header.framing, framing->GetName());
+    }
+
+    memcpy(out, &header, sizeof(header));
+
+    auto offsets = (uint32_t *)(out + sizeof(header));
+    auto flags = (uint8_t *)(offsets + (count + 1) * (framing ? 2 : 1));
+    memset(flags, 0, (count + 1) / 2);
+
+    size_t offset = tableSize;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        offsets[i] = (uint32_t)offset;
+        memcpy(out + offset, messages[i].message.data(), messages[i].message.size());
+        offset += messages[i].message.size();
+
+        flags[i / 2] |= WorkloadPackFlags(messages[i].flags) << (i % 2 * 4);
+    }
+
+    offsets[count] = (uint32_t)offset;
+
+    if (framing)
+    {
+        memcpy(offsets + count + 1, stuffedOffsets.data(), stuffedOffsets.size() * sizeof(uint32_t));
+        memcpy(out + offset, stuffed.data(), stuffed.size());
+    }
+
+    delete framing;
+    printf("Compiled %u messages from %s to %s (%zu bytes)\n", count, inputFilename, outputFilename.c_str(), size);
+    return 0;
+}